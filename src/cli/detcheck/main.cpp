@@ -22,6 +22,7 @@
 #include <nlohmann/json.hpp>
 #include "cli_options.h"
 #include "expr-wrappers/interpreter.h"
+#include "expr-wrappers/read-write-analysis.h"
 
 auto get_ntta(std::map<std::string, argument_t>& cli_arguments) -> std::unique_ptr<aaltitoad::ntta_t>;
 auto load_plugins(std::map<std::string, argument_t>& cli_arguments) -> plugin_map_t;
@@ -83,26 +84,6 @@ auto load_plugins(std::map<std::string, argument_t>& cli_arguments) -> plugin_ma
     return aaltitoad::plugins::load(look_dirs);
 }
 
-auto get_mentioned_symbols(const expr::syntax_tree_t& expression, const expr::symbol_table_t& symbols) -> expr::symbol_table_t {
-    expr::symbol_table_t mentioned{};
-    std::visit(ya::overload(
-            [&symbols, &mentioned](const expr::identifier_t& r) {
-                spdlog::trace("looking for '{0}' in symbols", r.ident);
-                mentioned[r.ident] = symbols.at(r.ident);
-            },
-            [&](const expr::root_t& r) {
-                if(!expression.children().empty())
-                    mentioned += get_mentioned_symbols(expression.children()[0], symbols);
-            },
-            [&](const expr::operator_t& r) {
-                for(auto& c: expression.children())
-                    mentioned += get_mentioned_symbols(c, symbols);
-            },
-            [](auto&&) {}
-    ), static_cast<const expr::underlying_syntax_node_t&>(expression.node));
-    return mentioned;
-}
-
 void find_deadlocks(const std::unique_ptr<aaltitoad::ntta_t>& ntta, std::map<std::string, argument_t>& cli_arguments) {
     ya::timer<unsigned int> t{};
     aaltitoad::expression_driver c{ntta->symbols, ntta->external_symbols};
@@ -148,11 +129,17 @@ void find_deadlocks(const std::unique_ptr<aaltitoad::ntta_t>& ntta, std::map<std
         for(auto& instance : data["instances"])
             instances.push_back(instance);
     }
+    auto all_symbols = ntta->symbols + ntta->external_symbols;
     for(auto& instance: instances) {
         spdlog::trace("looking for '{0}' in components", instance);
-        for(auto& location: ntta->components.at(instance).graph->nodes)
-            for(auto& edge: location.second.outgoing_edges)
-                unknown_symbols += get_mentioned_symbols(edge->second.data.guard, ntta->symbols + ntta->external_symbols);
+        for(auto& location: ntta->components.at(instance).graph->nodes) {
+            for(auto& edge: location.second.outgoing_edges) {
+                for(auto& id : aaltitoad::get_read_set(edge->second.data.guard, *ntta->interner).to_vector()) {
+                    auto& name = ntta->interner->name(id);
+                    unknown_symbols[name] = all_symbols.at(name);
+                }
+            }
+        }
     }
     spdlog::trace("finding {0} mentioned symbols in {1} tta instances took {2}ms", unknown_symbols.size(), instances.size(), t.milliseconds_elapsed());
 
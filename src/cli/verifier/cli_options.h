@@ -36,7 +36,25 @@ std::vector<option_t> get_options() {
             {"query-file",    'q', argument_requirement::REQUIRE_ARG,  "Query definition json file"},
             {"query",         'Q', argument_requirement::REQUIRE_ARG,  "Add a CTL query to verify"},
 
-            {"pick-strategy", 's', argument_requirement::REQUIRE_ARG,  "Waiting list pick strategy [first|last|random]. Default is first"},
+            {"pick-strategy", 's', argument_requirement::REQUIRE_ARG,  "Waiting list pick strategy [first|last|random|best-first]. Default is first"},
+            {"shortest-trace", 'S', argument_requirement::NO_ARG,      "Search breadth-first layer by layer, such that every trace has the fewest possible ticks"},
+            {"checkpoint",    'c', argument_requirement::REQUIRE_ARG,  "Write a search checkpoint to the provided file when interrupted (SIGINT/SIGTERM) and periodically"},
+            {"checkpoint-interval", 'M', argument_requirement::REQUIRE_ARG, "Minutes between periodic checkpoints. Default is 30, 0 only writes a checkpoint when interrupted"},
+            {"resume",        'r', argument_requirement::REQUIRE_ARG,  "Resume the search from the provided checkpoint file. The model and queries must be the same"},
+            {"memory-limit",  'l', argument_requirement::REQUIRE_ARG,  "MiB of resident memory the search may use. The passed list is degraded to hash compaction and then bitstate before the search stops"},
+            {"tree-compression", 'T', argument_requirement::NO_ARG,    "Store passed states with tree compression, sharing common parts of states. Traces are decoded when a solution is found"},
+            {"packed-states", 'K', argument_requirement::NO_ARG,       "Store passed states as bit-packed vectors, using the inferred domains of integer symbols. Traces are decoded when a solution is found"},
+            {"huge-pages",    'H', argument_requirement::NO_ARG,       "Back the passed list arena with transparent huge pages (linux only)"},
+            {"state-limit",   'n', argument_requirement::REQUIRE_ARG,  "Number of full states the search may store. The passed list is degraded to hash compaction when reached"},
+            {"no-slice",      'N', argument_requirement::NO_ARG,       "Disable cone-of-influence slicing of the model. Traces will include all components"},
+            {"no-dead-reset", 'D', argument_requirement::NO_ARG,       "Disable resetting dead symbols to their initial value. Traces will show the actual values of dead symbols"},
+            {"ctl-global",    'G', argument_requirement::NO_ARG,       "Enumerate the full state graph once and check arbitrarily nested CTL queries on it. No traces are produced"},
+            {"max-depth",     'd', argument_requirement::REQUIRE_ARG,  "Search depth-first up to the provided number of steps, only keeping the current path and a bounded state cache in memory"},
+            {"iterative-deepening", 'I', argument_requirement::NO_ARG, "Search depth-first with a depth bound that grows by one, such that shallow solutions are found first. Combine with --max-depth to limit the bound"},
+            {"state-cache",   'C', argument_requirement::REQUIRE_ARG,  "Number of encoded states to remember in depth-first modes. Default is 1048576, 0 disables the cache"},
+            {"external-memory", 'X', argument_requirement::REQUIRE_ARG, "Search breadth-first with the layers stored on disk in the provided scratch directory, removing duplicates by merging sorted files"},
+            {"ram-budget",    'R', argument_requirement::REQUIRE_ARG,  "MiB of successor states to buffer in memory before writing a sorted run in --external-memory mode. Default is 1024"},
+            {"bmc",           'B', argument_requirement::REQUIRE_ARG,  "Check E F and A G queries symbolically with Z3 up to the provided number of ticks instead of searching explicitly"},
 
             {"plugin-dir",    'P', argument_requirement::REQUIRE_ARG,  "Directories to look for parser plugins"},
             {"list-plugins",  'L', argument_requirement::NO_ARG,       "List found plugins and exit"},
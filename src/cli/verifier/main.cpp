@@ -22,6 +22,13 @@
 #include <timer>
 #include <plugin_system/plugin_system.h>
 #include <verification/forward_reachability.h>
+#include <verification/liveness_searcher.h>
+#include <verification/ctl/global_ctl_checker.h>
+#include <verification/bounded_model_checker.h>
+#include <verification/depth_bounded_searcher.h>
+#include <verification/checkpoint.h>
+#include <verification/external_memory_searcher.h>
+#include <verification/cone_of_influence.h>
 #include <ntta/interesting_tocker.h>
 #include "cli_options.h"
 #include "../cli_common.h"
@@ -89,21 +96,154 @@ int main(int argc, char** argv) {
         }
         for(auto& f : cli_arguments["query-file"].as_list_or_default({})) {
             spdlog::trace("loading queries in file {0}", f);
-            auto json_queries = aaltitoad::load_query_json_file(f, {n->symbols, n->external_symbols});
+            auto json_queries = aaltitoad::load_query_json_file(f, {n->symbols, n->external_symbols}, !cli_arguments["ctl-global"]);
             queries.insert(queries.end(), json_queries.begin(), json_queries.end());
         }
         spdlog::debug("query parsing took {0}ms", t.milliseconds_elapsed());
 
+        if(!cli_arguments["no-slice"]) {
+            t.start();
+            aaltitoad::slice_statistics_t slice_statistics{};
+            n = std::make_unique<aaltitoad::ntta_t>(aaltitoad::slice(*n, queries, slice_statistics));
+            spdlog::debug("model slicing took {0}ms", t.milliseconds_elapsed());
+        }
+
         auto strategy_s = cli_arguments["pick-strategy"].as_string_or_default("first");
+        std::replace(strategy_s.begin(), strategy_s.end(), '-', '_');
         auto strategy = magic_enum::enum_cast<aaltitoad::pick_strategy>(strategy_s).value_or(aaltitoad::pick_strategy::first);
         spdlog::debug("using pick strategy '{0}'", magic_enum::enum_name(strategy));
 
         n->add_tocker(std::make_unique<aaltitoad::interesting_tocker>());
-        spdlog::trace("starting reachability search for {0} queries", queries.size());
+        if(cli_arguments["ctl-global"]) {
+            spdlog::trace("starting global ctl checking for {0} queries", queries.size());
+            t.start();
+            aaltitoad::global_ctl_checker checker{*n};
+            auto json_results = "[]"_json;
+            for(auto& query : queries) {
+                auto holds = checker.is_satisfied(query);
+                std::stringstream ss{}; ss << query;
+                if(cli_arguments["result-json"])
+                    json_results.push_back({{"query", ss.str()}, {"holds", holds}});
+                else
+                    std::cout << ss.str() << ": " << std::boolalpha << holds << "\n";
+            }
+            if(cli_arguments["result-json"])
+                std::cout << json_results << std::endl;
+            spdlog::info("global ctl checking took {0}ms", t.milliseconds_elapsed());
+            return 0;
+        }
+        if(cli_arguments["bmc"]) {
+            auto bound = cli_arguments["bmc"].as_integer();
+            spdlog::trace("starting bounded model checking for {0} queries with bound {1}", queries.size(), bound);
+            t.start();
+            aaltitoad::bounded_model_checker bmc{*n, bound < 0 ? 0u : static_cast<unsigned int>(bound)};
+            auto json_results = "[]"_json;
+            for(auto& result : bmc.check(queries)) {
+                if(!result.supported)
+                    continue;
+                std::stringstream ss{}; ss << result.query;
+                if(cli_arguments["result-json"]) {
+                    nlohmann::json res{{"query", ss.str()}, {"holds", result.holds()}, {"bound", bound}};
+                    if(result.trace.has_value()) {
+                        res["trace"] = "[]"_json;
+                        for(auto& state : result.trace.value())
+                            res["trace"].push_back(state.to_json());
+                    }
+                    json_results.push_back(res);
+                    continue;
+                }
+                std::cout << ss.str() << ": " << std::boolalpha << result.holds();
+                // without a trace, nothing is known beyond the bound
+                if(!result.trace.has_value())
+                    std::cout << " (up to " << bound << " ticks)";
+                if(aaltitoad::is_negated_query(result.kind) && result.trace.has_value())
+                    std::cout << " counterexample:";
+                std::cout << "\n";
+                if(result.trace.has_value())
+                    for(auto& state : result.trace.value())
+                        std::cout << state << "\n";
+            }
+            if(cli_arguments["result-json"])
+                std::cout << json_results << std::endl;
+            spdlog::info("bounded model checking took {0}ms", t.milliseconds_elapsed());
+            return 0;
+        }
+        std::vector<ctl::syntax_tree_t> reachability_queries{}, liveness_queries{};
+        for(auto& q : queries) {
+            if(aaltitoad::is_liveness_query(aaltitoad::get_query_kind(q)))
+                liveness_queries.push_back(q);
+            else
+                reachability_queries.push_back(q);
+        }
+        spdlog::trace("starting reachability search for {0} queries", reachability_queries.size());
         t.start();
         aaltitoad::forward_reachability_searcher frs{strategy};
-        auto results = frs.is_reachable(*n, queries);
+        frs.set_dead_variable_reduction(!cli_arguments["no-dead-reset"]);
+        frs.set_shortest_trace(static_cast<bool>(cli_arguments["shortest-trace"]));
+        frs.set_tree_compression(static_cast<bool>(cli_arguments["tree-compression"]));
+        frs.set_packed_states(static_cast<bool>(cli_arguments["packed-states"]));
+        frs.set_huge_pages(static_cast<bool>(cli_arguments["huge-pages"]));
+        if(cli_arguments["checkpoint"]) {
+            auto interval = cli_arguments["checkpoint-interval"].as_integer_or_default(30);
+            frs.set_checkpoint(cli_arguments["checkpoint"].as_string(), std::chrono::minutes{interval});
+        }
+        if(cli_arguments["resume"])
+            frs.set_resume(cli_arguments["resume"].as_string());
+        aaltitoad::search_limits_t limits{};
+        if(cli_arguments["memory-limit"]) {
+            auto memory_limit = cli_arguments["memory-limit"].as_integer();
+            limits.memory_limit = (memory_limit < 1 ? size_t{1} : static_cast<size_t>(memory_limit)) << 20;
+        }
+        if(cli_arguments["state-limit"]) {
+            auto state_limit = cli_arguments["state-limit"].as_integer();
+            limits.state_limit = state_limit < 1 ? size_t{1} : static_cast<size_t>(state_limit);
+        }
+        frs.set_limits(limits);
+        aaltitoad::install_interrupt_handlers();
+        aaltitoad::depth_bounded_searcher::config_t dbs_config{};
+        dbs_config.iterative_deepening = static_cast<bool>(cli_arguments["iterative-deepening"]);
+        if(cli_arguments["max-depth"]) {
+            auto max_depth = cli_arguments["max-depth"].as_integer();
+            dbs_config.max_depth = max_depth < 0 ? 0u : static_cast<unsigned int>(max_depth);
+        }
+        if(cli_arguments["state-cache"]) {
+            auto cache_size = cli_arguments["state-cache"].as_integer();
+            dbs_config.cache_size = cache_size < 0 ? 0u : static_cast<size_t>(cache_size);
+        }
+        aaltitoad::depth_bounded_searcher dbs{dbs_config}; // owns the depth-first traces, so it must outlive the results
+        aaltitoad::external_memory_searcher::config_t ems_config{cli_arguments["external-memory"].as_string_or_default(".")};
+        if(cli_arguments["ram-budget"]) {
+            auto ram_budget = cli_arguments["ram-budget"].as_integer();
+            ems_config.ram_budget = (ram_budget < 1 ? size_t{1} : static_cast<size_t>(ram_budget)) << 20;
+        }
+        aaltitoad::external_memory_searcher ems{ems_config}; // owns the external memory traces
+        auto use_dbs = cli_arguments["max-depth"] || cli_arguments["iterative-deepening"];
+        auto use_ems = !use_dbs && cli_arguments["external-memory"];
+        auto results = use_dbs ? dbs.search(*n, reachability_queries)
+                     : use_ems ? ems.search(*n, reachability_queries)
+                     : frs.is_reachable(*n, reachability_queries);
         spdlog::info("reachability search took {0}ms", t.milliseconds_elapsed());
+        if(aaltitoad::is_interrupted())
+            spdlog::warn("the search was interrupted, queries without a solution are undecided");
+        aaltitoad::liveness_searcher ls{}; // owns the liveness traces, so it must outlive the results
+        if(!liveness_queries.empty()) {
+            spdlog::trace("starting liveness search for {0} queries", liveness_queries.size());
+            t.start();
+            auto liveness_results = ls.search(*n, liveness_queries);
+            results.insert(results.end(), liveness_results.begin(), liveness_results.end());
+            spdlog::info("liveness search took {0}ms", t.milliseconds_elapsed());
+        }
+
+        // queries without a solution are undecided when the reachability search did not cover the full state-space
+        auto& statistics = frs.get_statistics();
+        auto is_incomplete = use_dbs ? !dbs.is_complete()
+                           : use_ems ? !ems.is_complete()
+                           : statistics.stopped || statistics.storage != aaltitoad::storage_mode_t::full;
+        auto is_undecided = [is_incomplete, &ls](const aaltitoad::forward_reachability_searcher::query_solution_t& result) {
+            if(result.solution.has_value())
+                return false;
+            return aaltitoad::is_liveness_query(result.kind) ? !ls.is_complete() : is_incomplete;
+        };
 
         // open the results file (std::cout by default)
         spdlog::trace("opening results file stream");
@@ -120,15 +260,26 @@ int main(int argc, char** argv) {
                 nlohmann::json res{};
                 std::stringstream ss{}; ss << result.query;
                 res["query"] = ss.str();
-                if(result.solution.has_value())
+                res["holds"] = result.holds();
+                if(is_undecided(result))
+                    res["undecided"] = true;
+                if(result.solution.has_value()) {
+                    res["depth"] = result.solution.value()->second.metadata.depth;
                     res["trace"] = to_json(result.solution.value());
+                }
                 json_results.push_back(res);
             }
             *trace_stream << json_results << std::endl;
         } else {
             spdlog::trace("printing resuls data (non-json)");
             for(auto& result : results) {
-                *trace_stream << result.query << ": " << std::boolalpha << result.solution.has_value();
+                *trace_stream << result.query << ": " << std::boolalpha << result.holds();
+                if(is_undecided(result))
+                    *trace_stream << " (undecided)";
+                if(result.solution.has_value())
+                    *trace_stream << " (depth " << result.solution.value()->second.metadata.depth << ")";
+                if(aaltitoad::is_negated_query(result.kind) && result.solution.has_value())
+                    *trace_stream << " counterexample:\n";
                 if(result.solution.has_value())
                     *trace_stream << result.solution.value();
             }
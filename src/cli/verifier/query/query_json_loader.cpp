@@ -25,7 +25,7 @@
 #include "util/warnings.h"
 
 namespace aaltitoad {
-    auto load_query_json_file(const std::string& json_file, std::initializer_list<std::reference_wrapper<expr::symbol_table_t>> environments) -> std::vector<ctl::syntax_tree_t> {
+    auto load_query_json_file(const std::string& json_file, std::initializer_list<std::reference_wrapper<expr::symbol_table_t>> environments, bool only_searchable) -> std::vector<ctl::syntax_tree_t> {
         try {
             std::vector<ctl::syntax_tree_t> result{};
             ctl_interpreter c{environments};
@@ -36,7 +36,7 @@ namespace aaltitoad {
                 auto query = c.compile(q["query"]);
                 std::stringstream ss{}; ss << query;
                 spdlog::trace("resulting tree: {0}", ss.str());
-                if(!aaltitoad::is_query_searchable(query))
+                if(only_searchable && !aaltitoad::is_query_searchable(query))
                     warnings::warn(unsupported_query, std::string(q["query"])+" is not supported by aaltitoad - ignoring");
                 else
                     result.emplace_back(std::move(query));
@@ -73,10 +73,15 @@ namespace aaltitoad {
                         if(v.operator_type == ctl::modal_op_t::E && std::get<ctl::quantifier_t>(c.node).operator_type == ctl::quantifier_op_t::F)
                             return is_query_trivial(cc);
 
-                        if(v.operator_type == ctl::modal_op_t::A && std::get<ctl::quantifier_t>(c.node).operator_type == ctl::quantifier_op_t::G) {
-                            spdlog::debug("safety queries (A G <query>) are not supported yet. See issue #41 if you need this feature");
-                            return false;
-                        }
+                        // Safety queries are searched as reachability of the negated predicate
+                        if(v.operator_type == ctl::modal_op_t::A && std::get<ctl::quantifier_t>(c.node).operator_type == ctl::quantifier_op_t::G)
+                            return is_query_trivial(cc);
+
+                        // Liveness queries (E G <query> and A F <query>) are searched for lassos
+                        if(v.operator_type == ctl::modal_op_t::E && std::get<ctl::quantifier_t>(c.node).operator_type == ctl::quantifier_op_t::G)
+                            return is_query_trivial(cc);
+                        if(v.operator_type == ctl::modal_op_t::A && std::get<ctl::quantifier_t>(c.node).operator_type == ctl::quantifier_op_t::F)
+                            return is_query_trivial(cc);
 
                         return false;
                     },
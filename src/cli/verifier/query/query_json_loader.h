@@ -21,7 +21,7 @@
 #include <ctl_syntax_tree.h>
 
 namespace aaltitoad {
-    auto load_query_json_file(const std::string& json_file, std::initializer_list<std::reference_wrapper<expr::symbol_table_t>> environments) -> std::vector<ctl::syntax_tree_t>;
+    auto load_query_json_file(const std::string& json_file, std::initializer_list<std::reference_wrapper<expr::symbol_table_t>> environments, bool only_searchable = true) -> std::vector<ctl::syntax_tree_t>;
     auto is_query_searchable(const ctl::syntax_tree_t& q) -> bool;
     auto is_query_trivial(const ctl::syntax_tree_t& q) -> bool;
 }
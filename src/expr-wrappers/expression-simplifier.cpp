@@ -0,0 +1,166 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "expression-simplifier.h"
+#include "driver/evaluator.h"
+#include "operations/symbol-operator.h"
+#include <spdlog/spdlog.h>
+
+namespace aaltitoad {
+    auto expression_simplifier::statistics_t::operator+=(const statistics_t& other) -> statistics_t& {
+        nodes_eliminated += other.nodes_eliminated;
+        edges_eliminated += other.edges_eliminated;
+        return *this;
+    }
+
+    auto expression_simplifier::simplify(const expr::syntax_tree_t& tree) -> expr::syntax_tree_t {
+        auto before = count_nodes(tree);
+        auto result = fold(tree);
+        auto after = count_nodes(result);
+        if(after < before)
+            statistics.nodes_eliminated += before - after;
+        return result;
+    }
+
+    auto expression_simplifier::simplify(const expr::syntax_tree_collection_t& trees) -> expr::syntax_tree_collection_t {
+        expr::syntax_tree_collection_t result{};
+        for(auto& t : trees)
+            result[t.first] = simplify(t.second);
+        return result;
+    }
+
+    void expression_simplifier::mark_edge_eliminated() {
+        statistics.edges_eliminated++;
+    }
+
+    auto expression_simplifier::get_statistics() const -> const statistics_t& {
+        return statistics;
+    }
+
+    auto expression_simplifier::is_constant_false(const expr::syntax_tree_t& tree) -> bool { // NOLINT(misc-no-recursion)
+        if(std::holds_alternative<expr::root_t>(static_cast<const expr::underlying_syntax_node_t&>(tree.node)))
+            return !tree.children().empty() && is_constant_false(tree.children()[0]);
+        auto b = as_bool_literal(tree);
+        return b.has_value() && !b.value();
+    }
+
+    auto expression_simplifier::count_nodes(const expr::syntax_tree_t& tree) -> size_t { // NOLINT(misc-no-recursion)
+        size_t result = 1;
+        for(auto& c : tree.children())
+            result += count_nodes(c);
+        return result;
+    }
+
+    auto expression_simplifier::fold(const expr::syntax_tree_t& tree) -> expr::syntax_tree_t { // NOLINT(misc-no-recursion)
+        return std::visit(ya::overload(
+                [&](const expr::root_t& r) -> expr::syntax_tree_t {
+                    if(tree.children().empty())
+                        return tree;
+                    return expr::syntax_tree_t{r}.concat(fold(tree.children()[0]));
+                },
+                [&](const expr::operator_t& o) -> expr::syntax_tree_t {
+                    return fold_operator(o, tree);
+                },
+                [&](auto&&) -> expr::syntax_tree_t { return tree; }
+        ), static_cast<const expr::underlying_syntax_node_t&>(tree.node));
+    }
+
+    auto expression_simplifier::fold_operator(const expr::operator_t& op, const expr::syntax_tree_t& tree) -> expr::syntax_tree_t { // NOLINT(misc-no-recursion)
+        if(tree.children().empty() || tree.children().size() > 2)
+            return tree;
+        std::vector<expr::syntax_tree_t> c{};
+        for(auto& child : tree.children())
+            c.push_back(fold(child));
+
+        if(c.size() == 1) {
+            auto result = expr::syntax_tree_t{op}.concat(c[0]);
+            if(is_literal(c[0]))
+                return try_evaluate(result).value_or(result);
+            return result;
+        }
+
+        if(is_literal(c[0]) && is_literal(c[1])) {
+            auto result = expr::syntax_tree_t{op}.concat(c[0]).concat(c[1]);
+            return try_evaluate(result).value_or(result);
+        }
+
+        auto lhs = as_bool_literal(c[0]);
+        auto rhs = as_bool_literal(c[1]);
+        switch(op.operator_type) {
+            // 'true && x' is 'x' and 'false && x' is 'false'
+            case expr::operator_type_t::_and:
+                if(lhs.has_value())
+                    return lhs.value() ? c[1] : c[0];
+                if(rhs.has_value())
+                    return rhs.value() ? c[0] : c[1];
+                break;
+            // 'false || x' is 'x' and 'true || x' is 'true'
+            case expr::operator_type_t::_or:
+                if(lhs.has_value())
+                    return lhs.value() ? c[0] : c[1];
+                if(rhs.has_value())
+                    return rhs.value() ? c[1] : c[0];
+                break;
+            default:
+                break;
+        }
+
+        // Canonicalize comparisons such that literals are on the right-hand side, e.g. '2 < x' becomes 'x > 2'
+        auto flipped = flip(op.operator_type);
+        if(flipped.has_value() && is_literal(c[0]))
+            return expr::syntax_tree_t{expr::operator_t{flipped.value()}}.concat(c[1]).concat(c[0]);
+        return expr::syntax_tree_t{op}.concat(c[0]).concat(c[1]);
+    }
+
+    auto expression_simplifier::is_literal(const expr::syntax_tree_t& tree) -> bool {
+        return std::holds_alternative<expr::symbol_value_t>(static_cast<const expr::underlying_syntax_node_t&>(tree.node));
+    }
+
+    auto expression_simplifier::as_bool_literal(const expr::syntax_tree_t& tree) -> std::optional<bool> {
+        if(!is_literal(tree))
+            return {};
+        auto& v = std::get<expr::symbol_value_t>(static_cast<const expr::underlying_syntax_node_t&>(tree.node));
+        if(!std::holds_alternative<bool>(static_cast<const expr::underlying_symbol_value_t&>(v)))
+            return {};
+        return std::get<bool>(static_cast<const expr::underlying_symbol_value_t&>(v));
+    }
+
+    auto expression_simplifier::try_evaluate(const expr::syntax_tree_t& tree) -> std::optional<expr::syntax_tree_t> {
+        try {
+            expr::symbol_operator op{};
+            expr::evaluator e{{}, op};
+            return expr::syntax_tree_t{e.evaluate(tree)};
+        } catch(std::exception& e) {
+            // e.g. division by zero - leave it to the runtime to report it
+            std::stringstream ss{}; ss << tree;
+            spdlog::trace("unable to fold constant expression '{0}': {1}", ss.str(), e.what());
+            return {};
+        }
+    }
+
+    auto expression_simplifier::flip(const expr::operator_type_t& op) -> std::optional<expr::operator_type_t> {
+        switch(op) {
+            case expr::operator_type_t::_lt: return expr::operator_type_t::_gt;
+            case expr::operator_type_t::_le: return expr::operator_type_t::_ge;
+            case expr::operator_type_t::_gt: return expr::operator_type_t::_lt;
+            case expr::operator_type_t::_ge: return expr::operator_type_t::_le;
+            case expr::operator_type_t::_ee: return expr::operator_type_t::_ee;
+            case expr::operator_type_t::_ne: return expr::operator_type_t::_ne;
+            default: return {};
+        }
+    }
+}
@@ -0,0 +1,51 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_EXPRESSION_SIMPLIFIER_H
+#define AALTITOAD_EXPRESSION_SIMPLIFIER_H
+#include "interpreter.h"
+#include <symbol_table.h>
+
+namespace aaltitoad {
+    // Partially evaluates expressions at model build time.
+    // After template parameters have been substituted, many guards contain constant sub-expressions, e.g.
+    // 'id == 3 && x > 2' becomes '3 == 3 && x > 2' for instance id 3, which this simplifies to 'x > 2'.
+    class expression_simplifier {
+    public:
+        struct statistics_t {
+            size_t nodes_eliminated = 0;
+            size_t edges_eliminated = 0;
+            auto operator+=(const statistics_t& other) -> statistics_t&;
+        };
+        auto simplify(const expr::syntax_tree_t& tree) -> expr::syntax_tree_t;
+        auto simplify(const expr::syntax_tree_collection_t& trees) -> expr::syntax_tree_collection_t;
+        void mark_edge_eliminated();
+        auto get_statistics() const -> const statistics_t&;
+        static auto is_constant_false(const expr::syntax_tree_t& tree) -> bool;
+        static auto count_nodes(const expr::syntax_tree_t& tree) -> size_t;
+    private:
+        auto fold(const expr::syntax_tree_t& tree) -> expr::syntax_tree_t;
+        auto fold_operator(const expr::operator_t& op, const expr::syntax_tree_t& tree) -> expr::syntax_tree_t;
+        static auto is_literal(const expr::syntax_tree_t& tree) -> bool;
+        static auto as_bool_literal(const expr::syntax_tree_t& tree) -> std::optional<bool>;
+        static auto try_evaluate(const expr::syntax_tree_t& tree) -> std::optional<expr::syntax_tree_t>;
+        static auto flip(const expr::operator_type_t& op) -> std::optional<expr::operator_type_t>;
+        statistics_t statistics{};
+    };
+}
+
+#endif //AALTITOAD_EXPRESSION_SIMPLIFIER_H
@@ -0,0 +1,96 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "read-write-analysis.h"
+#include <spdlog/spdlog.h>
+
+namespace aaltitoad {
+    void collect_read_set(const expr::syntax_tree_t& expression, const symbol_interner_t& interner, symbol_set_t& result) { // NOLINT(misc-no-recursion)
+        std::visit(ya::overload(
+                [&](const expr::identifier_t& r) {
+                    auto id = interner.find(r.ident);
+                    if(id.has_value())
+                        result.insert(id.value());
+                    else
+                        spdlog::trace("'{0}' is not a known symbol, skipping it in read-set analysis", r.ident);
+                },
+                [](auto&&) {}
+        ), static_cast<const expr::underlying_syntax_node_t&>(expression.node));
+        for(auto& c : expression.children())
+            collect_read_set(c, interner, result);
+    }
+
+    auto get_read_set(const expr::syntax_tree_t& expression, const symbol_interner_t& interner) -> symbol_set_t {
+        symbol_set_t result{};
+        collect_read_set(expression, interner, result);
+        return result;
+    }
+
+    auto get_read_set(const expr::syntax_tree_collection_t& updates, const symbol_interner_t& interner) -> symbol_set_t {
+        symbol_set_t result{};
+        for(auto& update : updates)
+            collect_read_set(update.second, interner, result);
+        return result;
+    }
+
+    auto get_write_set(const expr::syntax_tree_collection_t& updates, const symbol_interner_t& interner) -> symbol_set_t {
+        symbol_set_t result{};
+        for(auto& update : updates) {
+            auto id = interner.find(update.first);
+            if(id.has_value())
+                result.insert(id.value());
+            else
+                spdlog::trace("'{0}' is not a known symbol, skipping it in write-set analysis", update.first);
+        }
+        return result;
+    }
+
+    void collect_read_set(const ctl::syntax_tree_t& query, const symbol_interner_t& interner, symbol_set_t& result) { // NOLINT(misc-no-recursion)
+        std::visit(ya::overload(
+                [&](const expr::syntax_tree_t& v) { collect_read_set(v, interner, result); },
+                [](auto&&) {}
+        ), static_cast<const ctl::underlying_syntax_node_t&>(query.node));
+        for(auto& c : query.children())
+            collect_read_set(c, interner, result);
+    }
+
+    auto get_read_set(const ctl::syntax_tree_t& query, const symbol_interner_t& interner) -> symbol_set_t {
+        symbol_set_t result{};
+        collect_read_set(query, interner, result);
+        return result;
+    }
+
+    void annotate_read_write_sets(ntta_t::tta_map_t& components, const symbol_interner_t& interner) {
+        for(auto& component : components) {
+            for(auto& edge : component.second.graph->edges) {
+                auto& data = edge.second.data;
+                data.reads = get_read_set(data.guard, interner);
+                data.reads |= get_read_set(data.updates, interner);
+                data.writes = get_write_set(data.updates, interner);
+            }
+            for(auto& node : component.second.graph->nodes) {
+                auto& data = node.second.data;
+                data.reads.clear();
+                data.writes.clear();
+                for(auto& edge : node.second.outgoing_edges) {
+                    data.reads |= edge->second.data.reads;
+                    data.writes |= edge->second.data.writes;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,38 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_READ_WRITE_ANALYSIS_H
+#define AALTITOAD_READ_WRITE_ANALYSIS_H
+#include "interpreter.h"
+#include "symbol-interner.h"
+#include <ctl_syntax_tree.h>
+#include <ntta/tta.h>
+
+namespace aaltitoad {
+    // The symbols that an expression mentions
+    auto get_read_set(const expr::syntax_tree_t& expression, const symbol_interner_t& interner) -> symbol_set_t;
+    // The symbols that the right-hand-sides of a collection of updates mention
+    auto get_read_set(const expr::syntax_tree_collection_t& updates, const symbol_interner_t& interner) -> symbol_set_t;
+    // The symbols that are assigned by a collection of updates
+    auto get_write_set(const expr::syntax_tree_collection_t& updates, const symbol_interner_t& interner) -> symbol_set_t;
+    // The symbols that the state predicates of a CTL query mention
+    auto get_read_set(const ctl::syntax_tree_t& query, const symbol_interner_t& interner) -> symbol_set_t;
+    // Stores the read/write sets of every edge and location on the component graphs
+    void annotate_read_write_sets(ntta_t::tta_map_t& components, const symbol_interner_t& interner);
+}
+
+#endif //AALTITOAD_READ_WRITE_ANALYSIS_H
@@ -0,0 +1,66 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "symbol-interner.h"
+#include <stdexcept>
+
+namespace aaltitoad {
+    symbol_interner_t::symbol_interner_t(const expr::symbol_table_t& internal_symbols, const expr::symbol_table_t& external_symbols) : names{}, positions{}, ids{} {
+        // a symbol that is declared both internally and externally keeps its internal position
+        uint32_t position = 0;
+        for(auto* table : {&internal_symbols, &external_symbols}) {
+            for(auto& s : *table) {
+                if(intern(s.first) == positions.size())
+                    positions.push_back(position);
+                position++;
+            }
+        }
+    }
+
+    auto symbol_interner_t::intern(const std::string& name) -> symbol_id_t {
+        auto it = ids.find(name);
+        if(it != ids.end())
+            return it->second;
+        auto id = static_cast<symbol_id_t>(names.size());
+        names.push_back(name);
+        ids[name] = id;
+        return id;
+    }
+
+    auto symbol_interner_t::find(const std::string& name) const -> std::optional<symbol_id_t> {
+        auto it = ids.find(name);
+        if(it == ids.end())
+            return {};
+        return it->second;
+    }
+
+    auto symbol_interner_t::name(const symbol_id_t& id) const -> const std::string& {
+        if(id >= names.size())
+            throw std::out_of_range("no such interned symbol id: " + std::to_string(id));
+        return names[id];
+    }
+
+    auto symbol_interner_t::size() const -> size_t {
+        return names.size();
+    }
+
+    auto symbol_interner_t::position(const symbol_id_t& id) const -> std::optional<uint32_t> {
+        if(id >= positions.size())
+            return {};
+        return positions[id];
+    }
+}
@@ -0,0 +1,123 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_SYMBOL_INTERNER_H
+#define AALTITOAD_SYMBOL_INTERNER_H
+#include <symbol_table.h>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace aaltitoad {
+    using symbol_id_t = uint32_t;
+
+    struct symbol_change_t {
+        symbol_id_t id;
+        expr::symbol_value_t value;
+    };
+    using symbol_changes_t = std::vector<symbol_change_t>;
+
+    // Maps symbol names to dense integer ids, such that sets of symbols can be represented as bitsets
+    class symbol_interner_t {
+    public:
+        symbol_interner_t() = default;
+        symbol_interner_t(const expr::symbol_table_t& internal_symbols, const expr::symbol_table_t& external_symbols);
+        auto intern(const std::string& name) -> symbol_id_t;
+        auto find(const std::string& name) const -> std::optional<symbol_id_t>;
+        auto name(const symbol_id_t& id) const -> const std::string&;
+        auto size() const -> size_t;
+        // the position of a declared symbol in the internal symbols followed by the external symbols. All states of
+        // a network share that order, see ntta_t::apply. Symbols that were interned later have no position
+        auto position(const symbol_id_t& id) const -> std::optional<uint32_t>;
+    private:
+        std::vector<std::string> names{};
+        std::vector<uint32_t> positions{}; // indexed by id
+        std::unordered_map<std::string, symbol_id_t> ids{};
+    };
+
+    // Compact set of interned symbol ids
+    class symbol_set_t {
+    public:
+        void insert(const symbol_id_t& id) {
+            auto word = id / 64;
+            if(word >= words.size())
+                words.resize(word + 1, 0);
+            words[word] |= uint64_t{1} << (id % 64);
+        }
+        auto contains(const symbol_id_t& id) const -> bool {
+            auto word = id / 64;
+            return word < words.size() && (words[word] & (uint64_t{1} << (id % 64))) != 0;
+        }
+        auto intersects(const symbol_set_t& other) const -> bool {
+            auto n = std::min(words.size(), other.words.size());
+            for(size_t i = 0; i < n; i++)
+                if((words[i] & other.words[i]) != 0)
+                    return true;
+            return false;
+        }
+        auto operator|=(const symbol_set_t& other) -> symbol_set_t& {
+            if(other.words.size() > words.size())
+                words.resize(other.words.size(), 0);
+            for(size_t i = 0; i < other.words.size(); i++)
+                words[i] |= other.words[i];
+            return *this;
+        }
+        auto operator-=(const symbol_set_t& other) -> symbol_set_t& {
+            auto n = std::min(words.size(), other.words.size());
+            for(size_t i = 0; i < n; i++)
+                words[i] &= ~other.words[i];
+            return *this;
+        }
+        auto operator==(const symbol_set_t& other) const -> bool {
+            auto n = std::max(words.size(), other.words.size());
+            for(size_t i = 0; i < n; i++) {
+                auto a = i < words.size() ? words[i] : 0;
+                auto b = i < other.words.size() ? other.words[i] : 0;
+                if(a != b)
+                    return false;
+            }
+            return true;
+        }
+        auto empty() const -> bool {
+            return std::all_of(words.begin(), words.end(), [](const uint64_t& w){ return w == 0; });
+        }
+        auto size() const -> size_t {
+            size_t result = 0;
+            for(auto& w : words)
+                result += std::popcount(w);
+            return result;
+        }
+        void clear() {
+            words.clear();
+        }
+        auto to_vector() const -> std::vector<symbol_id_t> {
+            std::vector<symbol_id_t> result{};
+            for(size_t i = 0; i < words.size(); i++)
+                for(auto w = words[i]; w != 0; w &= w - 1)
+                    result.push_back(static_cast<symbol_id_t>(i * 64 + std::countr_zero(w)));
+            return result;
+        }
+    private:
+        std::vector<uint64_t> words{};
+    };
+}
+
+#endif //AALTITOAD_SYMBOL_INTERNER_H
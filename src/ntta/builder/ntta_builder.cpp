@@ -19,10 +19,11 @@
 #include "expr-wrappers/interpreter.h"
 #include "ntta_builder.h"
 #include "symbol_table.h"
+#include <spdlog/spdlog.h>
 
 namespace aaltitoad {
     tta_builder::tta_builder(expression_driver* expression_compiler)
-     : compiler{expression_compiler}, factory{}, empty_guard{}, starting_location{}
+     : compiler{expression_compiler}, simplifier{}, factory{}, empty_guard{}, starting_location{}
     {
         empty_guard = compiler->parse_guard("");
     }
@@ -47,7 +48,14 @@ namespace aaltitoad {
         return *this;
     }
     auto tta_builder::add_edge(const edge_construction_element& e) -> tta_builder& {
-        factory.add_edge(e.source, e.target, {.guard=compile_guard(e.guard), .updates=compile_update(e.update)});
+        auto guard = compile_guard(e.guard);
+        if(expression_simplifier::is_constant_false(guard)) {
+            // statically disabled edges can never be taken, so there's no need to evaluate them at runtime
+            spdlog::trace("{0}: dropping statically disabled edge {1} -> {2}", tta_name.value_or("<unnamed>"), e.source, e.target);
+            simplifier.mark_edge_eliminated();
+            return *this;
+        }
+        factory.add_edge(e.source, e.target, {.guard=guard, .updates=compile_update(e.update)});
         return *this;
     }
     auto tta_builder::add_edges(const std::vector<edge_construction_element>& es) -> tta_builder& {
@@ -68,25 +76,30 @@ namespace aaltitoad {
         auto result = compiler->parse(guard.value());
         if(!result.expression)
             throw new std::logic_error("guard is not an expression");
-        return result.expression.value();
+        return simplifier.simplify(result.expression.value());
     }
     auto tta_builder::compile_update(const std::optional<std::string>& update) -> expr::syntax_tree_collection_t {
         if(!update.has_value())
             return {};
-        return compiler->parse(update.value()).declarations;
+        return simplifier.simplify(compiler->parse(update.value()).declarations);
+    }
+    auto tta_builder::get_statistics() const -> const expression_simplifier::statistics_t& {
+        return simplifier.get_statistics();
     }
 
-    ntta_builder::ntta_builder() : components{}, symbols{} {
+    ntta_builder::ntta_builder() : components{}, symbols{}, statistics{} {
 
     }
     auto ntta_builder::add_tta(tta_builder& builder) -> ntta_builder& {
         if(!builder.get_name().has_value())
             throw parse_error("cannot construct ntta: tta builder does not have a name set");
         components[builder.get_name().value()] = builder.build();
+        statistics += builder.get_statistics();
         return *this;
     }
     auto ntta_builder::add_tta(const std::string& name, tta_builder& builder) -> ntta_builder& {
         components[name] = builder.build();
+        statistics += builder.get_statistics();
         return *this;
     }
     auto ntta_builder::add_tta(const std::string& name, const tta_t& builder) -> ntta_builder& {
@@ -121,11 +134,16 @@ namespace aaltitoad {
         return *this;
     }
     auto ntta_builder::build() const -> ntta_t {
+        log_statistics();
         return aaltitoad::ntta_t{symbols, external_symbols, components};
     }
     auto ntta_builder::build_heap() const -> ntta_t* {
+        log_statistics();
         return new aaltitoad::ntta_t{symbols, external_symbols, components};
     }
+    void ntta_builder::log_statistics() const {
+        spdlog::debug("expression simplification eliminated {0} expression nodes and {1} statically disabled edges", statistics.nodes_eliminated, statistics.edges_eliminated);
+    }
     auto ntta_builder::build_with_interesting_tocker() const -> ntta_t {
         return build().add_tocker(std::make_shared<aaltitoad::interesting_tocker>());
     }
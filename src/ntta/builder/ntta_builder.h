@@ -18,6 +18,7 @@
 #ifndef AALTITOAD_NTTA_BUILDER_H
 #define AALTITOAD_NTTA_BUILDER_H
 #include "expr-wrappers/interpreter.h"
+#include "expr-wrappers/expression-simplifier.h"
 #include "ntta/tta.h"
 #include "ntta/interesting_tocker.h"
 #include "symbol_table.h"
@@ -39,8 +40,10 @@ namespace aaltitoad {
         auto compile_guard(const std::optional<std::string>& guard) -> expr::syntax_tree_t;
         auto compile_update(const std::optional<std::string>& update) -> expr::syntax_tree_collection_t;
         auto get_name() -> std::optional<std::string>;
+        auto get_statistics() const -> const expression_simplifier::statistics_t&;
     private:
         expression_driver* compiler;
+        expression_simplifier simplifier;
         aaltitoad::tta_t::graph_builder factory;
         expr::syntax_tree_t empty_guard;
         std::optional<std::string> starting_location;
@@ -69,6 +72,9 @@ namespace aaltitoad {
 
         aaltitoad::ntta_t::tta_map_t components;
         expr::symbol_table_t symbols, external_symbols;
+        expression_simplifier::statistics_t statistics;
+    private:
+        void log_statistics() const;
     };
 }
 
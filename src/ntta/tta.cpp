@@ -17,20 +17,66 @@
  */
 #include "tta.h"
 #include "symbol_table.h"
+#include "expr-wrappers/read-write-analysis.h"
 #include <setwrappers>
 #include <algorithm>
 #include <spdlog/spdlog.h>
 #include <util/warnings.h>
+#include <util/arena.h>
 
 namespace aaltitoad {
+    void ntta_t::analyse() {
+        auto network_interner = std::make_shared<symbol_interner_t>(symbols, external_symbols);
+        uint32_t component_id = 0;
+        for(auto& component : components)
+            component.second.component_id = component_id++;
+        // assignments to undeclared symbols still need an id, even though applying them will not insert anything
+        for(auto& component : components)
+            for(auto& edge : component.second.graph->edges)
+                for(auto& update : edge.second.data.updates)
+                    network_interner->intern(update.first);
+        for(auto& component : components) {
+            for(auto& edge : component.second.graph->edges) {
+                auto& data = edge.second.data;
+                data.interned_updates.clear();
+                for(auto& update : data.updates)
+                    data.interned_updates.emplace_back(network_interner->find(update.first).value(), update.second);
+            }
+        }
+        annotate_read_write_sets(components, *network_interner);
+        interner = network_interner;
+    }
+
+    auto to_symbol_table(const symbol_changes_t& changes, const symbol_interner_t& interner) -> expr::symbol_table_t {
+        expr::symbol_table_t result{};
+        for(auto& change : changes)
+            result[interner.name(change.id)] = change.value;
+        return result;
+    }
+
     auto ntta_t::state_change_t::operator+=(const choice_t& v) -> state_change_t & {
         location_changes.push_back(v.location_change);
-        symbol_changes += v.symbol_changes;
+        // later changes overwrite earlier ones, mirroring symbol_table_t::operator+=
+        for(auto& change : v.symbol_changes) {
+            auto it = std::find_if(symbol_changes.begin(), symbol_changes.end(), [&change](const symbol_change_t& c){ return c.id == change.id; });
+            if(it != symbol_changes.end())
+                it->value = change.value;
+            else
+                symbol_changes.push_back(change);
+        }
         return *this;
     }
 
-    auto ntta_t::eval_updates(expression_driver& i, const expr::syntax_tree_collection_t& t) -> expr::symbol_table_t {
-        return i.evaluate(t);
+    auto ntta_t::state_change_t::to_symbol_table(const symbol_interner_t& interner) const -> expr::symbol_table_t {
+        return aaltitoad::to_symbol_table(symbol_changes, interner);
+    }
+
+    auto ntta_t::eval_updates(expression_driver& i, const std::vector<std::pair<symbol_id_t, expr::syntax_tree_t>>& t) -> symbol_changes_t {
+        symbol_changes_t result{};
+        result.reserve(t.size());
+        for(auto& update : t)
+            result.push_back({update.first, i.evaluate(update.second)});
+        return result;
     }
 
     auto ntta_t::eval_guard(expression_driver& i, const expr::syntax_tree_t& e) -> expr::symbol_value_t {
@@ -68,7 +114,72 @@ namespace aaltitoad {
     void ntta_t::apply(const state_change_t &changes)  {
         for(auto& location_change : changes.location_changes)
             components.at(location_change.component->first).current_location = location_change.new_location;
-        apply(changes.symbol_changes);
+        // apply changes to internal and external symbols (overwrite, dont insert)
+        for(auto& change : changes.symbol_changes)
+            if(auto it = find_symbol(change.id); it.has_value())
+                it.value()->second = change.value;
+    }
+
+    void ntta_t::apply(const state_change_t& changes, undo_t& undo) {
+        for(auto& location_change : changes.location_changes) {
+            auto component = components.find(location_change.component->first);
+            undo.locations.emplace_back(component, component->second.current_location);
+            component->second.current_location = location_change.new_location;
+        }
+        for(auto& change : changes.symbol_changes) {
+            auto it = find_symbol(change.id);
+            if(!it.has_value())
+                continue;
+            undo.record(it.value());
+            it.value()->second = change.value;
+        }
+    }
+
+    auto ntta_t::find_symbol(const symbol_id_t& id) -> std::optional<expr::symbol_table_t::iterator> {
+        auto position = interner->position(id);
+        if(!position.has_value()) {
+            // symbols that were not declared when the network was analysed are looked up by name
+            auto& name = interner->name(id);
+            if(auto it = symbols.find(name); it != symbols.end())
+                return it;
+            if(auto it = external_symbols.find(name); it != external_symbols.end())
+                return it;
+            return {};
+        }
+        // the slots are only valid for the tables they were taken from
+        auto& slots = symbol_slots.slots;
+        auto first = symbols.empty() ? external_symbols.begin() : symbols.begin();
+        if(slots.size() != symbols.size() + external_symbols.size() || (!slots.empty() && slots.front() != first)) {
+            slots.clear();
+            for(auto it = symbols.begin(); it != symbols.end(); it++)
+                slots.push_back(it);
+            for(auto it = external_symbols.begin(); it != external_symbols.end(); it++)
+                slots.push_back(it);
+        }
+        if(position.value() >= slots.size())
+            return {};
+        return slots[position.value()];
+    }
+
+    void ntta_t::apply(const expr::symbol_table_t& symbol_changes, undo_t& undo) {
+        for(auto& change : symbol_changes) {
+            for(auto* table : {&symbols, &external_symbols}) {
+                auto it = table->find(change.first);
+                if(it == table->end())
+                    continue;
+                undo.record(it);
+                it->second = change.second;
+            }
+        }
+    }
+
+    void ntta_t::revert(undo_t& undo) {
+        for(auto it = undo.symbols.rbegin(); it != undo.symbols.rend(); it++)
+            it->first->second = it->second;
+        for(auto it = undo.locations.rbegin(); it != undo.locations.rend(); it++)
+            it->first->second.current_location = it->second;
+        undo.symbols.clear();
+        undo.locations.clear();
     }
 
     void ntta_t::apply(const expr::symbol_table_t& symbol_changes) {
@@ -98,15 +209,21 @@ namespace aaltitoad {
         apply(combined_changes);
     }
 
-    auto ntta_t::should_create_dependency_edge(const tta_t::graph_edge_iterator_t& e1, const tta_t::graph_edge_iterator_t& e2, expression_driver& i) const -> bool {
-        if(e1->second.source == e2->second.source)
-            return true;
-        auto changes1 = i.evaluate(e1->second.data.updates);
-        auto changes2 = i.evaluate(e2->second.data.updates);
-        if(changes1.is_overlapping_and_not_idempotent(changes2)) {
-            if(warnings::is_enabled(overlap_idem))
-                warnings::warn(overlap_idem, "overlapping and non-idempotent changes in tick-change calculation:", conflict_string(changes1, changes2));
+    auto ntta_t::should_create_dependency_edge(const choice_t& c1, const choice_t& c2) const -> bool {
+        if(c1.edge->second.source == c2.edge->second.source)
             return true;
+        // edges with disjoint write-sets can never conflict
+        if(!c1.edge->second.data.writes.intersects(c2.edge->second.data.writes))
+            return false;
+        for(auto& a : c1.symbol_changes) {
+            for(auto& b : c2.symbol_changes) {
+                if(a.id != b.id || !std::get<bool>(a.value != b.value))
+                    continue;
+                if(warnings::is_enabled(overlap_idem))
+                    warnings::warn(overlap_idem, "overlapping and non-idempotent changes in tick-change calculation:",
+                                   conflict_string(to_symbol_table(c1.symbol_changes, *interner), to_symbol_table(c2.symbol_changes, *interner)));
+                return true;
+            }
         }
         return false;
     }
@@ -114,22 +231,24 @@ namespace aaltitoad {
     auto ntta_t::calculate_edge_dependency_graph() -> tick_resolver::choice_dependency_problem {
         expression_driver i{symbols, external_symbols}; // BUG: external_symbols are not looked at yet
         tick_resolver::graph_type_builder graph_builder{};
-        std::unordered_map<std::string, choice_t> all_enabled_choices{};
+        std::pmr::unordered_map<std::string, choice_t> all_enabled_choices{memory::scratch_resource()};
         uint32_t unique_counter = 0;
         for(auto component_it = components.begin(); component_it != components.end(); component_it++) {
             for(auto& edge : component_it->second.current_location->second.outgoing_edges) {
                 if(!std::get<bool>(i.evaluate(edge->second.data.guard)))
                     continue;
+                // evaluate the updates once per tick, the dependency check reuses the result
+                choice_t choice{edge, {component_it, edge->second.target}, eval_updates(i, edge->second.data.interned_updates)};
                 for(auto& n : graph_builder.nodes)
-                    if(should_create_dependency_edge(edge, n.data, i))
+                    if(should_create_dependency_edge(choice, all_enabled_choices.at(n.data->first.identifier)))
                         graph_builder.add_edge(edge->first.identifier, n.data->first.identifier, unique_counter++);
 
                 graph_builder.add_node({edge->first.identifier, edge});
-                all_enabled_choices.insert({edge->first.identifier, choice_t{edge,{component_it,edge->second.target}, i.evaluate(edge->second.data.updates)}});
+                all_enabled_choices.insert({edge->first.identifier, std::move(choice)});
             }
         }
         try {
-            return { graph_builder.validate().optimize().build(), all_enabled_choices };
+            return { graph_builder.validate().optimize().build(), std::move(all_enabled_choices) };
         } catch (std::exception& e) {
             spdlog::critical("unable to generate enabled choice dependency graph: '{0}' please report this as an issue on github.com/sillydan1/AALTITOAD", e.what());
             throw;
@@ -233,3 +352,16 @@ auto operator==(const aaltitoad::ntta_t& a, const aaltitoad::ntta_t& b) -> bool
     // compare symbol tables
     return a.symbols == b.symbols && a.external_symbols == b.external_symbols;
 }
+
+namespace aaltitoad {
+    auto hash_symbol_values(const expr::symbol_table_t& symbols) -> size_t {
+        size_t result{};
+        for(auto& symbol : symbols) {
+            std::visit(ya::overload(
+                    [&result](const expr::clock_t& v){ result = ya::hash_combine(result, v.time_units); },
+                    [&result](auto&& v){ result = ya::hash_combine(result, v); }
+            ), static_cast<const expr::underlying_symbol_value_t&>(symbol.second));
+        }
+        return result;
+    }
+}
@@ -18,6 +18,7 @@
 #ifndef AALTITOAD_TTA_H
 #define AALTITOAD_TTA_H
 #include "expr-wrappers/interpreter.h"
+#include "expr-wrappers/symbol-interner.h"
 #include <nlohmann/json.hpp>
 #include <string>
 #include <graph>
@@ -28,17 +29,23 @@
 #include <permutation>
 #include <set>
 #include <future>
+#include <memory_resource>
 
 namespace aaltitoad {
     struct location_t {
         using graph_key_t = std::string;
         std::string identifier{ya::uuid_v4_custom("L", "")};
+        symbol_set_t reads{};  // union of the read sets of the outgoing edges
+        symbol_set_t writes{}; // union of the write sets of the outgoing edges
     };
 
     struct edge_t {
         std::string identifier{ya::uuid_v4_custom("E", "")};
         expr::syntax_tree_t guard{};
         expr::syntax_tree_collection_t updates{};
+        symbol_set_t reads{};
+        symbol_set_t writes{};
+        std::vector<std::pair<symbol_id_t, expr::syntax_tree_t>> interned_updates{};
         auto operator==(const edge_t& other) const -> bool {
             return identifier == other.identifier;
         }
@@ -63,6 +70,7 @@ namespace aaltitoad {
         std::shared_ptr<graph_t> graph;
         location_t::graph_key_t initial_location;
         graph_node_iterator_t current_location;
+        uint32_t component_id{}; // dense index of the component within its network
 
         tta_t() : graph{}, initial_location{}, current_location{graph->nodes.end()} {}
         tta_t(std::shared_ptr<graph_t> graph, location_t::graph_key_t initial_location)
@@ -91,24 +99,36 @@ namespace aaltitoad {
         struct choice_t {
             tta_t::graph_edge_iterator_t edge;
             location_change_t location_change;
-            expr::symbol_table_t symbol_changes;
+            symbol_changes_t symbol_changes;
         };
         struct state_change_t {
             std::vector<location_change_t> location_changes;
-            expr::symbol_table_t symbol_changes;
+            symbol_changes_t symbol_changes;
             auto operator+=(const choice_t&) -> state_change_t&;
+            auto to_symbol_table(const symbol_interner_t& interner) const -> expr::symbol_table_t;
+        };
+        // what in-place changes overwrote, such that successors can be probed without copying the state
+        struct undo_t {
+            std::vector<std::pair<tta_map_t::iterator, tta_t::graph_node_iterator_t>> locations{};
+            std::vector<std::pair<expr::symbol_table_t::iterator, expr::symbol_value_t>> symbols{};
+            void record(const expr::symbol_table_t::iterator& symbol) { symbols.emplace_back(symbol, symbol->second); }
+            auto empty() const -> bool { return locations.empty() && symbols.empty(); }
         };
 
         std::vector<std::shared_ptr<tocker_t>> tockers;
         expr::symbol_table_t symbols;
         expr::symbol_table_t external_symbols;
         tta_map_t components;
+        std::shared_ptr<const symbol_interner_t> interner;
 
-        ntta_t() : symbols{}, external_symbols{}, components{} {}
+        ntta_t() : symbols{}, external_symbols{}, components{}, interner{std::make_shared<symbol_interner_t>()} {}
         ntta_t(expr::symbol_table_t symbols, tta_map_t components)
-         : symbols{std::move(symbols)}, external_symbols{}, components{std::move(components)} {}
+         : symbols{std::move(symbols)}, external_symbols{}, components{std::move(components)}, interner{} { analyse(); }
         ntta_t(expr::symbol_table_t symbols, expr::symbol_table_t external_symbols, tta_map_t components)
-         : symbols{std::move(symbols)}, external_symbols{std::move(external_symbols)}, components{std::move(components)} {}
+         : symbols{std::move(symbols)}, external_symbols{std::move(external_symbols)}, components{std::move(components)}, interner{} { analyse(); }
+        // components must already be annotated by the provided interner, e.g. when they are taken from another network
+        ntta_t(expr::symbol_table_t symbols, expr::symbol_table_t external_symbols, tta_map_t components, std::shared_ptr<const symbol_interner_t> interner)
+         : symbols{std::move(symbols)}, external_symbols{std::move(external_symbols)}, components{std::move(components)}, interner{std::move(interner)} {}
 
         auto tick() -> std::vector<state_change_t>;
         auto tock() const -> std::vector<expr::symbol_table_t>;
@@ -117,9 +137,28 @@ namespace aaltitoad {
         void apply(const expr::symbol_table_t& external_symbol_changes);
         void apply(const std::vector<expr::symbol_table_t>& external_symbol_change_list);
         void apply_internal(const expr::symbol_table_t& symbol_changes);
+        // like apply, but the overwritten locations and values are appended to undo
+        void apply(const state_change_t& changes, undo_t& undo);
+        void apply(const expr::symbol_table_t& symbol_changes, undo_t& undo);
+        // restores everything recorded in undo, most recent change first, and clears it
+        void revert(undo_t& undo);
         auto to_string() const -> std::string;
         auto to_json() const -> nlohmann::json;
     private:
+        // iterators to the symbol values by position, see symbol_interner_t::position. They point into the tables of
+        // one state, so copies and moves start out empty and are filled again on the first apply
+        struct symbol_slots_t {
+            std::vector<expr::symbol_table_t::iterator> slots{};
+            symbol_slots_t() = default;
+            symbol_slots_t(const symbol_slots_t&) {}
+            symbol_slots_t(symbol_slots_t&&) noexcept {}
+            auto operator=(const symbol_slots_t&) -> symbol_slots_t& { slots.clear(); return *this; }
+            auto operator=(symbol_slots_t&&) noexcept -> symbol_slots_t& { slots.clear(); return *this; }
+        };
+        symbol_slots_t symbol_slots{};
+        // the symbol that a change with the provided id overwrites, if it is declared
+        auto find_symbol(const symbol_id_t& id) -> std::optional<expr::symbol_table_t::iterator>;
+        void analyse();
         class tick_resolver {
         public:
             using set = std::set<std::string>;
@@ -128,7 +167,7 @@ namespace aaltitoad {
             using graph_type_builder = ya::graph_builder<tta_t::graph_edge_iterator_t, uint32_t, std::string>;
             struct choice_dependency_problem {
                 graph_type dependency_graph;
-                std::unordered_map<std::string, choice_t> choices;
+                std::pmr::unordered_map<std::string, choice_t> choices; // allocated from memory::scratch_resource()
             };
 
             explicit tick_resolver(const graph_type& G);
@@ -142,8 +181,8 @@ namespace aaltitoad {
             set N;
         };
         auto calculate_edge_dependency_graph() -> tick_resolver::choice_dependency_problem;
-        auto should_create_dependency_edge(const tta_t::graph_edge_iterator_t& e1, const tta_t::graph_edge_iterator_t& e2, expression_driver& i) const -> bool;
-        static auto eval_updates(expression_driver& i, const expr::syntax_tree_collection_t& t) -> expr::symbol_table_t;
+        auto should_create_dependency_edge(const choice_t& c1, const choice_t& c2) const -> bool;
+        static auto eval_updates(expression_driver& i, const std::vector<std::pair<symbol_id_t, expr::syntax_tree_t>>& t) -> symbol_changes_t;
         static auto eval_guard(expression_driver& i, const expr::syntax_tree_t& e) -> expr::symbol_value_t;
     };
 
@@ -159,11 +198,17 @@ auto operator+(const aaltitoad::ntta_t& state, const aaltitoad::ntta_t::state_ch
 auto operator+(const aaltitoad::ntta_t& state, const expr::symbol_table_t& external_symbol_changes) -> aaltitoad::ntta_t;
 auto operator==(const aaltitoad::ntta_t& a, const aaltitoad::ntta_t& b) -> bool;
 
+namespace aaltitoad {
+    // All states of a network share the same symbol names in the same order, so only the values need hashing
+    auto hash_symbol_values(const expr::symbol_table_t& symbols) -> size_t;
+}
+
 namespace std {
     template<>
     struct hash<aaltitoad::tta_t> {
         inline auto operator()(const aaltitoad::tta_t& v) const -> size_t {
-            return std::hash<aaltitoad::location_t::graph_key_t>{}(v.current_location->first);
+            // location graphs are shared between states, so the node address identifies the location
+            return std::hash<const void*>{}(&(*v.current_location));
         }
     };
 
@@ -171,10 +216,8 @@ namespace std {
     struct hash<aaltitoad::ntta_t::tta_map_t> {
         inline auto operator()(const aaltitoad::ntta_t::tta_map_t& v) const -> size_t {
             size_t result{};
-            for(auto& t : v) {
-                result = ya::hash_combine(result, t.first);
+            for(auto& t : v)
                 result = ya::hash_combine(result, t.second);
-            }
             return result;
         }
     };
@@ -182,7 +225,7 @@ namespace std {
     template<>
     struct hash<aaltitoad::ntta_t> {
         inline auto operator()(const aaltitoad::ntta_t& v) const -> size_t {
-            return ya::hash_combine(v.symbols, v.components);
+            return ya::hash_combine(aaltitoad::hash_symbol_values(v.symbols), v.components);
         }
     };
 }
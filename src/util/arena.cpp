@@ -0,0 +1,129 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace aaltitoad::memory {
+    namespace {
+        constexpr size_t huge_page_size = size_t{2} << 20;
+        thread_local std::pmr::memory_resource* current_scratch = nullptr;
+    }
+
+    arena_resource::arena_resource(size_t chunk_size, bool huge_pages) : chunk_size{chunk_size}, huge_pages{huge_pages} {}
+
+    arena_resource::~arena_resource() {
+        release();
+    }
+
+    void arena_resource::set_huge_pages(bool enabled) {
+        huge_pages = enabled;
+    }
+
+    auto arena_resource::do_allocate(size_t bytes, size_t alignment) -> void* {
+        auto aligned = [this, alignment]() {
+            auto address = reinterpret_cast<uintptr_t>(cursor);
+            return reinterpret_cast<std::byte*>((address + alignment - 1) & ~(uintptr_t{alignment} - 1));
+        };
+        if(cursor == nullptr || aligned() + bytes > end)
+            add_chunk(bytes + alignment);
+        auto* result = aligned();
+        cursor = result + bytes;
+        statistics.allocations++;
+        statistics.bytes += bytes;
+        return result;
+    }
+
+    void arena_resource::do_deallocate(void*, size_t, size_t) {}
+
+    auto arena_resource::do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool {
+        return this == &other;
+    }
+
+    void arena_resource::add_chunk(size_t minimum_size) {
+        auto size = std::max(chunk_size, minimum_size);
+        chunk_t chunk{nullptr, size, false};
+#if defined(__linux__)
+        if(huge_pages) {
+            size = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+            auto* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(p != MAP_FAILED) {
+                madvise(p, size, MADV_HUGEPAGE); // a hint, the kernel may still use normal pages
+                chunk = {static_cast<std::byte*>(p), size, true};
+            }
+        }
+#endif
+        if(chunk.data == nullptr)
+            chunk.data = static_cast<std::byte*>(::operator new(size));
+        chunks.push_back(chunk);
+        statistics.chunks = chunks.size();
+        cursor = chunk.data;
+        end = chunk.data + chunk.size;
+    }
+
+    void arena_resource::free_chunk(const chunk_t& chunk) {
+#if defined(__linux__)
+        if(chunk.mapped) {
+            munmap(chunk.data, chunk.size);
+            return;
+        }
+#endif
+        ::operator delete(chunk.data);
+    }
+
+    void arena_resource::reset() {
+        if(chunks.empty())
+            return;
+        for(size_t i = 1; i < chunks.size(); i++)
+            free_chunk(chunks[i]);
+        chunks.resize(1);
+        cursor = chunks[0].data;
+        end = chunks[0].data + chunks[0].size;
+        statistics.bytes = 0;
+        statistics.chunks = 1;
+    }
+
+    void arena_resource::release() {
+        for(auto& chunk : chunks)
+            free_chunk(chunk);
+        chunks.clear();
+        cursor = end = nullptr;
+        statistics = {};
+    }
+
+    auto arena_resource::get_statistics() const -> const arena_statistics_t& {
+        return statistics;
+    }
+
+    auto scratch_resource() -> std::pmr::memory_resource* {
+        return current_scratch != nullptr ? current_scratch : std::pmr::get_default_resource();
+    }
+
+    scratch_scope::scratch_scope(arena_resource& arena) : arena{arena}, previous{current_scratch} {
+        current_scratch = &arena;
+    }
+
+    scratch_scope::~scratch_scope() {
+        current_scratch = previous;
+        arena.reset();
+    }
+}
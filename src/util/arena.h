@@ -0,0 +1,83 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_ARENA_H
+#define AALTITOAD_ARENA_H
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace aaltitoad::memory {
+    struct arena_statistics_t {
+        size_t allocations{}; // since construction or the last release()
+        size_t bytes{};       // currently handed out
+        size_t chunks{};      // currently owned
+    };
+
+    // Bump allocator. Deallocation is a no-op, memory is only given back by reset() and release().
+    // Chunks are optionally backed by transparent huge pages, which only has an effect on linux
+    class arena_resource : public std::pmr::memory_resource {
+    public:
+        explicit arena_resource(size_t chunk_size = size_t{1} << 20, bool huge_pages = false);
+        ~arena_resource() override;
+        arena_resource(const arena_resource&) = delete;
+        auto operator=(const arena_resource&) -> arena_resource& = delete;
+        void set_huge_pages(bool enabled); // only applies to new chunks
+        // keeps the first chunk for reuse, everything allocated from the arena must be dead
+        void reset();
+        // gives all chunks back to the system, everything allocated from the arena must be dead
+        void release();
+        auto get_statistics() const -> const arena_statistics_t&;
+
+    private:
+        struct chunk_t {
+            std::byte* data;
+            size_t size;
+            bool mapped;
+        };
+        size_t chunk_size;
+        bool huge_pages;
+        std::vector<chunk_t> chunks{};
+        std::byte* cursor{};
+        std::byte* end{};
+        arena_statistics_t statistics{};
+
+        auto do_allocate(size_t bytes, size_t alignment) -> void* override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override;
+        void add_chunk(size_t minimum_size);
+        void free_chunk(const chunk_t& chunk);
+    };
+
+    // Per-thread resource for short lived scratch data, e.g. the choices of ntta_t::tick.
+    // It is the default memory resource unless a scratch_scope is active on the thread
+    auto scratch_resource() -> std::pmr::memory_resource*;
+
+    // Installs an arena as the scratch resource of the current thread, and resets it when the scope ends
+    class scratch_scope {
+    public:
+        explicit scratch_scope(arena_resource& arena);
+        ~scratch_scope();
+        scratch_scope(const scratch_scope&) = delete;
+        auto operator=(const scratch_scope&) -> scratch_scope& = delete;
+    private:
+        arena_resource& arena;
+        std::pmr::memory_resource* previous;
+    };
+}
+
+#endif //AALTITOAD_ARENA_H
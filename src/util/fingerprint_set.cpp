@@ -0,0 +1,187 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "fingerprint_set.h"
+#include <algorithm>
+#include <bit>
+
+namespace aaltitoad {
+    namespace {
+        auto remap(uint64_t fingerprint) -> uint64_t {
+            return fingerprint <= 1 ? fingerprint + 2 : fingerprint;
+        }
+    }
+
+    concurrent_fingerprint_set::table_t::table_t(size_t bucket_count)
+     : bucket_count{bucket_count}, buckets{std::make_unique<bucket_t[]>(bucket_count)} {}
+
+    concurrent_fingerprint_set::concurrent_fingerprint_set(size_t initial_capacity)
+     : initial_buckets{std::bit_ceil(std::max<size_t>(initial_capacity / slots_per_bucket, 1))},
+       current{new table_t(initial_buckets)}, oldest{current.load()} {}
+
+    concurrent_fingerprint_set::~concurrent_fingerprint_set() {
+        free_tables(nullptr);
+    }
+
+    auto concurrent_fingerprint_set::home(const table_t& t, uint64_t fingerprint) -> size_t {
+        // fingerprints are not necessarily well mixed, e.g. indices
+        auto h = fingerprint * 0x9e3779b97f4a7c15ull;
+        return (h ^ (h >> 29)) & (t.bucket_count - 1);
+    }
+
+    auto concurrent_fingerprint_set::insert(uint64_t fingerprint) -> bool {
+        fingerprint = remap(fingerprint);
+        auto* t = current.load(std::memory_order_acquire);
+        while(true) {
+            help_migrate(*t);
+            switch(insert_into(*t, fingerprint)) {
+                case insert_result_t::inserted:
+                    count.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                case insert_result_t::present:
+                    return false;
+                case insert_result_t::moved:
+                    t = t->next.load(std::memory_order_acquire);
+                    break;
+            }
+        }
+    }
+
+    auto concurrent_fingerprint_set::insert_into(table_t& t, uint64_t fingerprint) -> insert_result_t {
+        auto slot_count = t.bucket_count * slots_per_bucket;
+        auto first = home(t, fingerprint) * slots_per_bucket;
+        for(size_t probe = 0; probe < slot_count; probe++) {
+            auto i = (first + probe) & (slot_count - 1);
+            auto& slot = t.buckets[i / slots_per_bucket].slots[i % slots_per_bucket];
+            auto v = slot.load(std::memory_order_acquire);
+            while(v == empty) {
+                // the fingerprint can not be further along the probe sequence, since it would have taken this slot
+                if(t.next.load(std::memory_order_acquire) != nullptr) {
+                    if(slot.compare_exchange_weak(v, sealed, std::memory_order_acq_rel, std::memory_order_acquire))
+                        return insert_result_t::moved;
+                } else if(slot.compare_exchange_weak(v, fingerprint, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    if(t.occupied.fetch_add(1, std::memory_order_relaxed) + 1 > slot_count / 4 * 3)
+                        grow(t);
+                    return insert_result_t::inserted;
+                }
+            }
+            if(v == fingerprint)
+                return insert_result_t::present;
+            if(v == sealed)
+                return insert_result_t::moved;
+        }
+        grow(t);
+        return insert_result_t::moved;
+    }
+
+    void concurrent_fingerprint_set::grow(table_t& t) {
+        if(t.next.load(std::memory_order_acquire) != nullptr)
+            return;
+        auto* n = new table_t(t.bucket_count * 2);
+        table_t* expected = nullptr;
+        if(!t.next.compare_exchange_strong(expected, n, std::memory_order_acq_rel))
+            delete n; // another thread was first
+    }
+
+    void concurrent_fingerprint_set::help_migrate(table_t& t) {
+        auto* n = t.next.load(std::memory_order_acquire);
+        if(n == nullptr)
+            return;
+        auto begin = t.claimed.fetch_add(migration_chunk, std::memory_order_relaxed);
+        if(begin >= t.bucket_count)
+            return;
+        auto end = std::min(begin + migration_chunk, t.bucket_count);
+        for(auto b = begin; b < end; b++) {
+            for(auto& slot : t.buckets[b].slots) {
+                auto v = slot.load(std::memory_order_acquire);
+                while(v == empty && !slot.compare_exchange_weak(v, sealed, std::memory_order_acq_rel, std::memory_order_acquire)) {}
+                if(v == empty || v == sealed)
+                    continue;
+                for(auto* target = n; insert_into(*target, v) == insert_result_t::moved; target = target->next.load(std::memory_order_acquire)) {}
+            }
+        }
+        if(t.migrated.fetch_add(end - begin) + (end - begin) != t.bucket_count)
+            return;
+        // every fingerprint of t is in the tables behind it. An older table may still be current, in which case
+        // the thread that finishes that table moves past t as well
+        for(auto* c = &t; c->migrated.load() == c->bucket_count; c = c->next.load()) {
+            auto* expected = c;
+            if(!current.compare_exchange_strong(expected, c->next.load()))
+                break;
+        }
+    }
+
+    auto concurrent_fingerprint_set::contains(uint64_t fingerprint) const -> bool {
+        fingerprint = remap(fingerprint);
+        for(auto* t = current.load(std::memory_order_acquire); t != nullptr; t = t->next.load(std::memory_order_acquire)) {
+            auto slot_count = t->bucket_count * slots_per_bucket;
+            auto first = home(*t, fingerprint) * slots_per_bucket;
+            for(size_t probe = 0; probe < slot_count; probe++) {
+                auto i = (first + probe) & (slot_count - 1);
+                auto v = t->buckets[i / slots_per_bucket].slots[i % slots_per_bucket].load(std::memory_order_acquire);
+                if(v == fingerprint)
+                    return true;
+                if(v == empty || v == sealed)
+                    break;
+            }
+        }
+        return false;
+    }
+
+    auto concurrent_fingerprint_set::size() const -> size_t {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    auto concurrent_fingerprint_set::capacity() const -> size_t {
+        auto* t = current.load(std::memory_order_acquire);
+        for(auto* n = t->next.load(std::memory_order_acquire); n != nullptr; n = n->next.load(std::memory_order_acquire))
+            t = n;
+        return t->bucket_count * slots_per_bucket;
+    }
+
+    auto concurrent_fingerprint_set::memory_bytes() const -> size_t {
+        size_t result = 0;
+        for(auto* t = oldest; t != nullptr; t = t->next.load(std::memory_order_acquire))
+            result += sizeof(table_t) + t->bucket_count * sizeof(bucket_t);
+        return result;
+    }
+
+    auto concurrent_fingerprint_set::finish_migrations() -> table_t* {
+        for(auto* t = current.load(); t->next.load() != nullptr; t = current.load())
+            help_migrate(*t);
+        return current.load();
+    }
+
+    void concurrent_fingerprint_set::free_tables(table_t* until) {
+        while(oldest != until) {
+            auto* next = oldest->next.load();
+            delete oldest;
+            oldest = next;
+        }
+    }
+
+    void concurrent_fingerprint_set::reclaim() {
+        free_tables(current.load());
+    }
+
+    void concurrent_fingerprint_set::clear() {
+        free_tables(nullptr);
+        oldest = new table_t(initial_buckets);
+        current.store(oldest);
+        count.store(0);
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_FINGERPRINT_SET_H
+#define AALTITOAD_FINGERPRINT_SET_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace aaltitoad {
+    // Lock-free, insert-only set of 64 bit state fingerprints, e.g. hashes for hash compaction or indices into a
+    // state store. Open addressing over buckets of one cache line, probed linearly from the bucket of the fingerprint.
+    // Inserting is a compare-and-swap of an empty slot, so any number of threads may insert and look up concurrently.
+    // When a table is 3/4 full, a table of twice the size is linked behind it, and every insert migrates a chunk of
+    // buckets before inserting, such that no thread has to wait for the whole table to be copied. Empty slots of a
+    // table that is being migrated are sealed, so late inserts move on to the next table.
+    // Fingerprints 0 and 1 mark empty and sealed slots, and are stored as 2 and 3 instead, so indices should be offset by 2
+    class concurrent_fingerprint_set {
+    public:
+        explicit concurrent_fingerprint_set(size_t initial_capacity = 1024);
+        ~concurrent_fingerprint_set();
+        concurrent_fingerprint_set(const concurrent_fingerprint_set&) = delete;
+        auto operator=(const concurrent_fingerprint_set&) -> concurrent_fingerprint_set& = delete;
+
+        // true if the fingerprint was not in the set. Exactly one of any number of concurrent inserts of a
+        // fingerprint returns true
+        auto insert(uint64_t fingerprint) -> bool;
+        auto contains(uint64_t fingerprint) const -> bool;
+        auto size() const -> size_t;
+        auto capacity() const -> size_t; // slots of the newest table
+        auto memory_bytes() const -> size_t;
+
+        // The following must not run concurrently with any other member function
+        // frees the tables that have been migrated
+        void reclaim();
+        void clear();
+        // completes pending migrations and calls f with every stored fingerprint
+        template<typename F>
+        void for_each(F&& f) {
+            auto* t = finish_migrations();
+            for(size_t b = 0; b < t->bucket_count; b++)
+                for(auto& slot : t->buckets[b].slots)
+                    if(auto v = slot.load(std::memory_order_relaxed); v != empty && v != sealed)
+                        f(v);
+        }
+
+    private:
+        static constexpr uint64_t empty = 0, sealed = 1;
+        static constexpr size_t slots_per_bucket = 8;
+        static constexpr size_t migration_chunk = 64; // buckets
+        struct alignas(64) bucket_t {
+            std::atomic<uint64_t> slots[slots_per_bucket];
+        };
+        struct table_t {
+            explicit table_t(size_t bucket_count);
+            size_t bucket_count; // power of two
+            std::unique_ptr<bucket_t[]> buckets;
+            std::atomic<size_t> occupied{};
+            std::atomic<table_t*> next{};
+            std::atomic<size_t> claimed{};  // buckets handed out to migrating threads
+            std::atomic<size_t> migrated{}; // buckets that have been migrated
+        };
+        enum class insert_result_t {
+            inserted, present, moved
+        };
+        size_t initial_buckets;
+        std::atomic<table_t*> current;
+        table_t* oldest; // owns the chain of tables through next
+        std::atomic<size_t> count{};
+
+        static auto home(const table_t& t, uint64_t fingerprint) -> size_t;
+        auto insert_into(table_t& t, uint64_t fingerprint) -> insert_result_t;
+        void grow(table_t& t);
+        void help_migrate(table_t& t);
+        auto finish_migrations() -> table_t*;
+        void free_tables(table_t* until);
+    };
+}
+
+#endif //AALTITOAD_FINGERPRINT_SET_H
@@ -0,0 +1,180 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "hash_kernel.h"
+#include <cstring>
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define AALTITOAD_AVX2_KERNEL
+#include <immintrin.h>
+#endif
+
+namespace aaltitoad::hashing {
+    namespace {
+        constexpr size_t lanes = 4;
+        constexpr size_t stripe_size = lanes * sizeof(uint64_t);
+        constexpr uint64_t secret[lanes] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+        constexpr uint64_t step[lanes] = {0x9e3779b97f4a7c15ull, 0xc2b2ae3d27d4eb4full, 0x165667b19e3779f9ull, 0x27d4eb2f165667c5ull};
+
+        auto load(const unsigned char* p) -> uint64_t {
+            uint64_t w;
+            std::memcpy(&w, p, sizeof(w));
+            return w;
+        }
+
+        // xor of the halves of the 128 bit product
+        auto mum(uint64_t a, uint64_t b) -> uint64_t {
+#if defined(__SIZEOF_INT128__)
+            auto r = static_cast<unsigned __int128>(a) * b;
+            return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#else
+            auto al = a & 0xffffffff, ah = a >> 32, bl = b & 0xffffffff, bh = b >> 32;
+            auto ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+            auto mid = (ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff);
+            auto lo = (ll & 0xffffffff) | (mid << 32);
+            auto hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+            return lo ^ hi;
+#endif
+        }
+
+        // lane i of stripe s: acc[i] += lo32(w ^ k) * hi32(w ^ k) + w, where k = secret[i] + s * step[i]
+        void accumulate_scalar(const unsigned char* data, size_t stripes, uint64_t* acc) {
+            uint64_t keys[lanes] = {secret[0], secret[1], secret[2], secret[3]};
+            for(size_t s = 0; s < stripes; s++, data += stripe_size) {
+                for(size_t i = 0; i < lanes; i++) {
+                    auto w = load(data + i * sizeof(uint64_t));
+                    auto k = w ^ keys[i];
+                    acc[i] += (k & 0xffffffff) * (k >> 32) + w;
+                    keys[i] += step[i];
+                }
+            }
+        }
+
+        auto equal_scalar(const unsigned char* a, const unsigned char* b, size_t size) -> bool {
+            return std::memcmp(a, b, size) == 0;
+        }
+
+#ifdef AALTITOAD_AVX2_KERNEL
+        __attribute__((target("avx2")))
+        void accumulate_avx2(const unsigned char* data, size_t stripes, uint64_t* acc) {
+            auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc));
+            auto keys = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret));
+            auto steps = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(step));
+            for(size_t s = 0; s < stripes; s++, data += stripe_size) {
+                auto w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+                auto k = _mm256_xor_si256(w, keys);
+                auto product = _mm256_mul_epu32(k, _mm256_srli_epi64(k, 32));
+                a = _mm256_add_epi64(a, _mm256_add_epi64(product, w));
+                keys = _mm256_add_epi64(keys, steps);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc), a);
+        }
+
+        __attribute__((target("avx2")))
+        auto equal_avx2(const unsigned char* a, const unsigned char* b, size_t size) -> bool {
+            size_t i = 0;
+            for(; i + stripe_size <= size; i += stripe_size) {
+                auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+                if(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)) != -1)
+                    return false;
+            }
+            return std::memcmp(a + i, b + i, size - i) == 0;
+        }
+#endif
+
+        struct kernel_functions_t {
+            kernel_t kernel;
+            void (*accumulate)(const unsigned char*, size_t, uint64_t*);
+            bool (*equal)(const unsigned char*, const unsigned char*, size_t);
+        };
+
+        auto functions(kernel_t kernel) -> kernel_functions_t {
+#ifdef AALTITOAD_AVX2_KERNEL
+            if(kernel == kernel_t::avx2)
+                return {kernel_t::avx2, accumulate_avx2, equal_avx2};
+#endif
+            return {kernel_t::scalar, accumulate_scalar, equal_scalar};
+        }
+
+        auto active() -> kernel_functions_t& {
+            static kernel_functions_t k = functions(is_supported(kernel_t::avx2) ? kernel_t::avx2 : kernel_t::scalar);
+            return k;
+        }
+    }
+
+    auto is_supported(kernel_t kernel) -> bool {
+        switch(kernel) {
+            case kernel_t::scalar: return true;
+#ifdef AALTITOAD_AVX2_KERNEL
+            case kernel_t::avx2: return __builtin_cpu_supports("avx2");
+#endif
+            default: return false;
+        }
+    }
+
+    auto active_kernel() -> kernel_t {
+        return active().kernel;
+    }
+
+    auto use_kernel(kernel_t kernel) -> bool {
+        if(!is_supported(kernel))
+            return false;
+        active() = functions(kernel);
+        return true;
+    }
+
+    auto to_string(kernel_t kernel) -> const char* {
+        switch(kernel) {
+            case kernel_t::scalar: return "scalar";
+            case kernel_t::avx2: return "avx2";
+            default: return "unknown";
+        }
+    }
+
+    auto hash_bytes(const void* data, size_t size, uint64_t seed) -> uint64_t {
+        auto* p = static_cast<const unsigned char*>(data);
+        uint64_t acc[lanes] = {secret[0] ^ seed, secret[1], secret[2], secret[3]};
+        auto stripes = size / stripe_size;
+        if(stripes > 0)
+            active().accumulate(p, stripes, acc);
+        auto h = mum(seed ^ size ^ step[0], secret[0]);
+        for(size_t i = 0; i < lanes; i++)
+            h = mum(h ^ acc[i], secret[i] ^ step[i]);
+        auto* tail = p + stripes * stripe_size;
+        auto remaining = size % stripe_size;
+        for(; remaining >= sizeof(uint64_t); remaining -= sizeof(uint64_t), tail += sizeof(uint64_t))
+            h = mum(h ^ load(tail), secret[remaining / sizeof(uint64_t) % lanes] ^ step[1]);
+        if(remaining > 0) {
+            uint64_t w = 0;
+            std::memcpy(&w, tail, remaining);
+            h = mum(h ^ w, secret[1] ^ step[2]);
+        }
+        return mum(h ^ secret[3], step[3]);
+    }
+
+    auto hash_words(const uint64_t* words, size_t count, uint64_t seed) -> uint64_t {
+        return hash_bytes(words, count * sizeof(uint64_t), seed);
+    }
+
+    auto equal_bytes(const void* a, const void* b, size_t size) -> bool {
+        return active().equal(static_cast<const unsigned char*>(a), static_cast<const unsigned char*>(b), size);
+    }
+
+    auto equal_words(const uint64_t* a, const uint64_t* b, size_t count) -> bool {
+        return equal_bytes(a, b, count * sizeof(uint64_t));
+    }
+}
@@ -0,0 +1,43 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_HASH_KERNEL_H
+#define AALTITOAD_HASH_KERNEL_H
+#include <cstddef>
+#include <cstdint>
+
+namespace aaltitoad::hashing {
+    enum class kernel_t {
+        scalar, avx2
+    };
+
+    // The kernel is selected once from the features of the cpu. All kernels compute the same hashes
+    auto active_kernel() -> kernel_t;
+    auto is_supported(kernel_t kernel) -> bool;
+    // returns false, and keeps the active kernel, if the cpu does not support the kernel
+    auto use_kernel(kernel_t kernel) -> bool;
+    auto to_string(kernel_t kernel) -> const char*;
+
+    // 64 bit hash in the style of xxh3: four lanes of 64 bit words are accumulated with 32x32 bit multiplications
+    // against position dependent keys, which vectorizes, and the lanes and the tail are folded with 128 bit multiplications
+    auto hash_words(const uint64_t* words, size_t count, uint64_t seed = 0) -> uint64_t;
+    auto hash_bytes(const void* data, size_t size, uint64_t seed = 0) -> uint64_t;
+    auto equal_words(const uint64_t* a, const uint64_t* b, size_t count) -> bool;
+    auto equal_bytes(const void* a, const void* b, size_t size) -> bool;
+}
+
+#endif //AALTITOAD_HASH_KERNEL_H
@@ -0,0 +1,313 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "bounded_model_checker.h"
+#include <spdlog/spdlog.h>
+#include <timer>
+
+namespace aaltitoad {
+    bounded_model_checker::bounded_model_checker(const ntta_t& s0, unsigned int bound)
+     : s0{s0}, bound{bound}, context{}, solver{context}, steps{}, locations_by_id{}, location_ids{} {
+        for(auto& component : s0.components) {
+            auto& ids = location_ids[component.first];
+            auto& nodes = locations_by_id[component.first];
+            for(auto it = component.second.graph->nodes.begin(); it != component.second.graph->nodes.end(); it++) {
+                ids[&(*it)] = static_cast<int>(nodes.size());
+                nodes.push_back(it);
+            }
+        }
+    }
+
+    auto bounded_model_checker::check(const std::vector<ctl::syntax_tree_t>& queries) -> std::vector<result_t> {
+        std::vector<result_t> results{};
+        for(auto& query : queries) {
+            auto kind = get_query_kind(query);
+            auto supported = kind == query_kind_t::reachability || kind == query_kind_t::safety;
+            if(!supported) {
+                std::stringstream ss{}; ss << query;
+                spdlog::warn("bounded model checking only supports E F and A G queries, skipping '{0}'", ss.str());
+            }
+            results.push_back({query, kind, supported, {}});
+        }
+        auto is_pending = [](const result_t& r){ return r.supported && !r.trace.has_value(); };
+        add_initial_step();
+        for(size_t k = 0; k <= bound; k++) {
+            ya::timer<int> t{};
+            if(k > 0)
+                add_transition();
+            for(size_t q = 0; q < results.size(); q++) {
+                if(!is_pending(results[q]))
+                    continue;
+                // reachability is checked under an assumption, such that the unrolling can be reused for the next k
+                auto target = encode(results[q].query, steps[k]);
+                if(results[q].kind == query_kind_t::safety)
+                    target = !target;
+                auto indicator = context.bool_const(("query_" + std::to_string(q) + "_" + std::to_string(k)).c_str());
+                solver.add(z3::implies(indicator, target));
+                z3::expr_vector assumptions{context};
+                assumptions.push_back(indicator);
+                if(solver.check(assumptions) == z3::sat) {
+                    spdlog::debug("query {0} decided at depth {1}", q, k);
+                    results[q].trace = reconstruct(solver.get_model(), k);
+                }
+            }
+            spdlog::debug("bounded model checking depth {0} took {1}ms", k, t.milliseconds_elapsed());
+            if(std::none_of(results.begin(), results.end(), is_pending))
+                break;
+        }
+        return results;
+    }
+
+    auto bounded_model_checker::is_clock(const expr::symbol_value_t& v) -> bool {
+        return std::holds_alternative<expr::clock_t>(static_cast<const expr::underlying_symbol_value_t&>(v));
+    }
+
+    auto bounded_model_checker::make_symbol(const std::string& name, const expr::symbol_value_t& type, size_t step) -> z3::expr {
+        auto n = name + "_" + std::to_string(step);
+        return std::visit(ya::overload(
+                [&](const int&) { return context.int_const(n.c_str()); },
+                [&](const float&) { return context.real_const(n.c_str()); },
+                [&](const bool&) { return context.bool_const(n.c_str()); },
+                [&](const expr::clock_t&) { return context.int_const(n.c_str()); },
+                [&](auto&&) -> z3::expr { throw std::logic_error(name + ": symbol type is not supported by bounded model checking"); }
+        ), static_cast<const expr::underlying_symbol_value_t&>(type));
+    }
+
+    auto bounded_model_checker::encode(const expr::symbol_value_t& literal) -> z3::expr {
+        return std::visit(ya::overload(
+                [&](const int& v) { return context.int_val(v); },
+                [&](const float& v) { return context.real_val(std::to_string(v).c_str()); },
+                [&](const bool& v) { return context.bool_val(v); },
+                [&](const expr::clock_t& v) { return context.int_val(static_cast<int>(v.time_units)); },
+                [&](auto&&) -> z3::expr { throw std::logic_error("literal type is not supported by bounded model checking"); }
+        ), static_cast<const expr::underlying_symbol_value_t&>(literal));
+    }
+
+    void bounded_model_checker::add_initial_step() {
+        step_t step{};
+        for(auto& component : s0.components) {
+            auto l = context.int_const(("location_" + component.first + "_0").c_str());
+            solver.add(l == location_ids.at(component.first).at(&(*component.second.current_location)));
+            step.locations.emplace(component.first, l);
+        }
+        for(auto& symbol : s0.symbols) {
+            auto s = make_symbol(symbol.first, symbol.second, 0);
+            solver.add(s == encode(symbol.second));
+            step.symbols.emplace(symbol.first, s);
+        }
+        // the environment may change the external symbols before the first tick
+        for(auto& symbol : s0.external_symbols)
+            step.symbols.emplace(symbol.first, make_symbol(symbol.first, symbol.second, 0));
+        steps.push_back(step);
+    }
+
+    void bounded_model_checker::add_transition() {
+        auto i = steps.size() - 1;
+        auto& from = steps[i];
+        struct edge_encoding_t {
+            std::string component;
+            int source, target;
+            z3::expr enabled, take;
+            std::map<std::string, z3::expr> updates;
+        };
+        std::vector<edge_encoding_t> edges{};
+        for(auto& component : s0.components) {
+            auto& ids = location_ids.at(component.first);
+            auto& location = from.locations.at(component.first);
+            for(auto& edge : component.second.graph->edges) {
+                auto source = ids.at(&(*edge.second.source));
+                auto target = ids.at(&(*edge.second.target));
+                auto enabled = location == source && encode(edge.second.data.guard, from);
+                auto take = context.bool_const(("take_" + component.first + "_" + edge.first.identifier + "_" + std::to_string(i)).c_str());
+                std::map<std::string, z3::expr> updates{};
+                for(auto& update : edge.second.data.updates)
+                    if(from.symbols.contains(update.first))
+                        updates.emplace(update.first, encode(update.second, from));
+                solver.add(z3::implies(take, enabled));
+                edges.push_back({component.first, source, target, enabled, take, updates});
+            }
+        }
+        // two edges conflict if they share a source location or assign different values to the same symbol
+        auto conflict = [this](const edge_encoding_t& a, const edge_encoding_t& b) -> z3::expr {
+            if(a.component == b.component)
+                return context.bool_val(a.source == b.source);
+            auto result = context.bool_val(false);
+            for(auto& u : a.updates) {
+                auto other = b.updates.find(u.first);
+                if(other != b.updates.end())
+                    result = result || u.second != other->second;
+            }
+            return result.simplify();
+        };
+        for(size_t a = 0; a < edges.size(); a++) {
+            auto blocked = context.bool_val(false);
+            for(size_t b = 0; b < edges.size(); b++) {
+                if(a == b)
+                    continue;
+                auto c = conflict(edges[a], edges[b]);
+                if(c.is_false())
+                    continue;
+                if(a < b)
+                    solver.add(!(edges[a].take && edges[b].take && c));
+                blocked = blocked || (edges[b].take && c);
+            }
+            // maximality: an enabled edge may only be left out if it conflicts with a taken edge
+            solver.add(z3::implies(edges[a].enabled && !edges[a].take, blocked));
+        }
+
+        step_t to{};
+        for(auto& location : from.locations) {
+            auto next = location.second;
+            for(auto& e : edges)
+                if(e.component == location.first)
+                    next = z3::ite(e.take, context.int_val(e.target), next);
+            auto l = context.int_const(("location_" + location.first + "_" + std::to_string(i + 1)).c_str());
+            solver.add(l == next);
+            to.locations.emplace(location.first, l);
+        }
+        auto delay = context.int_const(("delay_" + std::to_string(i)).c_str());
+        solver.add(delay >= 0);
+        for(auto& symbol : s0.symbols) {
+            auto next = from.symbols.at(symbol.first);
+            for(auto& e : edges) {
+                auto u = e.updates.find(symbol.first);
+                if(u != e.updates.end())
+                    next = z3::ite(e.take, u->second, next);
+            }
+            // clocks advance by the same delay during the tock step
+            if(is_clock(symbol.second))
+                next = next + delay;
+            auto s = make_symbol(symbol.first, symbol.second, i + 1);
+            solver.add(s == next);
+            to.symbols.emplace(symbol.first, s);
+        }
+        for(auto& symbol : s0.external_symbols)
+            to.symbols.emplace(symbol.first, make_symbol(symbol.first, symbol.second, i + 1));
+        steps.push_back(to);
+    }
+
+    auto bounded_model_checker::encode(const expr::syntax_tree_t& expression, const step_t& step) -> z3::expr { // NOLINT(misc-no-recursion)
+        auto unify = [](z3::expr& a, z3::expr& b) {
+            if(a.is_int() && b.is_real()) a = z3::to_real(a);
+            if(a.is_real() && b.is_int()) b = z3::to_real(b);
+        };
+        return std::visit(ya::overload(
+                [&](const expr::identifier_t& r) -> z3::expr {
+                    auto it = step.symbols.find(r.ident);
+                    if(it == step.symbols.end())
+                        throw std::out_of_range(r.ident + ": no such symbol");
+                    return it->second;
+                },
+                [&](const expr::symbol_value_t& v) -> z3::expr { return encode(v); },
+                [&](const expr::root_t&) -> z3::expr {
+                    if(expression.children().empty())
+                        return context.bool_val(true);
+                    return encode(expression.children()[0], step);
+                },
+                [&](const expr::operator_t& o) -> z3::expr {
+                    auto a = encode(expression.children()[0], step);
+                    if(expression.children().size() == 1) {
+                        switch(o.operator_type) {
+                            case expr::operator_type_t::_not:   return !a;
+                            case expr::operator_type_t::_minus: return -a;
+                            default: return a;
+                        }
+                    }
+                    auto b = encode(expression.children()[1], step);
+                    unify(a, b);
+                    switch(o.operator_type) {
+                        case expr::operator_type_t::_plus:    return a + b;
+                        case expr::operator_type_t::_minus:   return a - b;
+                        case expr::operator_type_t::_star:    return a * b;
+                        case expr::operator_type_t::_slash:   return a / b;
+                        case expr::operator_type_t::_percent: return z3::mod(a, b);
+                        case expr::operator_type_t::_and:     return a && b;
+                        case expr::operator_type_t::_or:      return a || b;
+                        case expr::operator_type_t::_xor:     return a != b;
+                        case expr::operator_type_t::_implies: return z3::implies(a, b);
+                        case expr::operator_type_t::_lt:      return a < b;
+                        case expr::operator_type_t::_le:      return a <= b;
+                        case expr::operator_type_t::_gt:      return a > b;
+                        case expr::operator_type_t::_ge:      return a >= b;
+                        case expr::operator_type_t::_ee:      return a == b;
+                        case expr::operator_type_t::_ne:      return a != b;
+                        default: throw std::logic_error("operator is not supported by bounded model checking");
+                    }
+                },
+                [](auto&&) -> z3::expr { throw std::logic_error("expression node is not supported by bounded model checking"); }
+        ), static_cast<const expr::underlying_syntax_node_t&>(expression.node));
+    }
+
+    auto bounded_model_checker::encode(const ctl::syntax_tree_t& formula, const step_t& step) -> z3::expr { // NOLINT(misc-no-recursion)
+        return std::visit(ya::overload(
+                [&](const expr::syntax_tree_t& v) -> z3::expr { return encode(v, step); },
+                [&](const ctl::location_t& v) -> z3::expr {
+                    auto result = context.bool_val(false);
+                    for(auto& component : location_ids)
+                        for(auto& node : locations_by_id.at(component.first))
+                            if(node->first == v.location_name)
+                                result = result || step.locations.at(component.first) == component.second.at(&(*node));
+                    return result;
+                },
+                [&](const expr::operator_t& v) -> z3::expr {
+                    auto a = encode(formula.children()[0], step);
+                    if(v.operator_type == expr::operator_type_t::_not)
+                        return !a;
+                    auto b = encode(formula.children()[1], step);
+                    switch(v.operator_type) {
+                        case expr::operator_type_t::_and:     return a && b;
+                        case expr::operator_type_t::_or:      return a || b;
+                        case expr::operator_type_t::_xor:     return a != b;
+                        case expr::operator_type_t::_implies: return z3::implies(a, b);
+                        default: throw std::logic_error("not a valid CTL operator");
+                    }
+                },
+                // modals and quantifiers are stripped, the query kind decides how the predicate is used
+                [&](auto&&) -> z3::expr { return encode(formula.children()[0], step); }
+        ), static_cast<const ctl::underlying_syntax_node_t&>(formula.node));
+    }
+
+    auto bounded_model_checker::reconstruct(const z3::model& model, size_t depth) const -> std::vector<ntta_t> {
+        std::vector<ntta_t> trace{};
+        for(size_t k = 0; k <= depth; k++) {
+            auto state = s0;
+            for(auto& location : steps[k].locations) {
+                auto id = model.eval(location.second, true).get_numeral_int();
+                state.components.at(location.first).current_location = locations_by_id.at(location.first).at(id);
+            }
+            auto assign = [&model](expr::symbol_table_t& table, const std::string& name, const z3::expr& value) {
+                auto v = model.eval(value, true);
+                auto& current = table.find(name)->second;
+                std::visit(ya::overload(
+                        [&](const int&) { current = v.get_numeral_int(); },
+                        [&](const float&) { current = static_cast<float>(v.as_double()); },
+                        [&](const bool&) { current = v.is_true(); },
+                        [&](const expr::clock_t&) { current = expr::clock_t{static_cast<decltype(expr::clock_t::time_units)>(v.get_numeral_int())}; },
+                        [](auto&&) {}
+                ), static_cast<const expr::underlying_symbol_value_t&>(current));
+            };
+            for(auto& symbol : steps[k].symbols) {
+                if(state.symbols.contains(symbol.first))
+                    assign(state.symbols, symbol.first, symbol.second);
+                else
+                    assign(state.external_symbols, symbol.first, symbol.second);
+            }
+            trace.push_back(state);
+        }
+        return trace;
+    }
+}
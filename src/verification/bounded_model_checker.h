@@ -0,0 +1,67 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_BOUNDED_MODEL_CHECKER_H
+#define AALTITOAD_BOUNDED_MODEL_CHECKER_H
+#include "verification/ctl/ctl_sat.h"
+#include <ctl_syntax_tree.h>
+#include <ntta/tta.h>
+#include <z3++.h>
+#include <map>
+#include <vector>
+
+namespace aaltitoad {
+    // Symbolic bounded model checker. Unrolls the network for up to K tick/tock steps in Z3 and checks
+    // E F and A G queries incrementally for k = 0..K. Every tick takes a maximal set of non-conflicting
+    // enabled edges, and every tock lets the environment pick arbitrary values for the external symbols
+    class bounded_model_checker {
+    public:
+        struct result_t {
+            ctl::syntax_tree_t query;
+            query_kind_t kind;
+            bool supported;
+            std::optional<std::vector<ntta_t>> trace; // witness for E F queries, counterexample for A G queries
+            auto holds() const -> bool { return kind == query_kind_t::safety ? !trace.has_value() : trace.has_value(); }
+        };
+        bounded_model_checker(const ntta_t& s0, unsigned int bound);
+        auto check(const std::vector<ctl::syntax_tree_t>& queries) -> std::vector<result_t>;
+
+    private:
+        struct step_t {
+            std::map<std::string, z3::expr> locations{};
+            std::map<std::string, z3::expr> symbols{};
+        };
+        const ntta_t& s0;
+        unsigned int bound;
+        z3::context context{};
+        z3::solver solver;
+        std::vector<step_t> steps{};
+        std::map<std::string, std::vector<tta_t::graph_node_iterator_t>> locations_by_id{};
+        std::map<std::string, std::unordered_map<const void*, int>> location_ids{};
+
+        void add_initial_step();
+        void add_transition();
+        auto make_symbol(const std::string& name, const expr::symbol_value_t& type, size_t step) -> z3::expr;
+        auto encode(const expr::symbol_value_t& literal) -> z3::expr;
+        auto encode(const expr::syntax_tree_t& expression, const step_t& step) -> z3::expr;
+        auto encode(const ctl::syntax_tree_t& formula, const step_t& step) -> z3::expr;
+        auto reconstruct(const z3::model& model, size_t depth) const -> std::vector<ntta_t>;
+        static auto is_clock(const expr::symbol_value_t& v) -> bool;
+    };
+}
+
+#endif //AALTITOAD_BOUNDED_MODEL_CHECKER_H
@@ -0,0 +1,167 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "checkpoint.h"
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <spdlog/spdlog.h>
+
+namespace aaltitoad {
+    namespace {
+        constexpr char magic[] = {'A', 'A', 'L', 'T', 'C', 'K', 'P', 'T'};
+        constexpr uint64_t version = 4;
+        volatile std::sig_atomic_t interrupted = 0;
+
+        void on_interrupt(int signal) {
+            interrupted = 1;
+            std::signal(signal, SIG_DFL);
+        }
+
+        void write_string(const std::string& s, bytes_t& out) {
+            write_varint(s.size(), out);
+            out.insert(out.end(), s.begin(), s.end());
+        }
+
+        auto read_string(const uint8_t*& cursor, const uint8_t* end) -> std::string {
+            auto size = read_varint(cursor, end);
+            if(size > static_cast<uint64_t>(end - cursor))
+                throw std::out_of_range("unexpected end of checkpoint");
+            std::string result{reinterpret_cast<const char*>(cursor), size};
+            cursor += size;
+            return result;
+        }
+    }
+
+    void install_interrupt_handlers() {
+        interrupted = 0;
+        std::signal(SIGINT, on_interrupt);
+        std::signal(SIGTERM, on_interrupt);
+    }
+
+    auto is_interrupted() -> bool {
+        return interrupted != 0;
+    }
+
+    checkpoint_writer::checkpoint_writer(const state_codec& codec, const std::vector<std::string>& queries) : codec{codec} {
+        buffer.insert(buffer.end(), std::begin(magic), std::end(magic));
+        write_varint(version, buffer);
+        write_varint(codec.fingerprint(), buffer);
+        write_varint(queries.size(), buffer);
+        for(auto& q : queries)
+            write_string(q, buffer);
+    }
+
+    void checkpoint_writer::begin_section(size_t count) {
+        write_varint(count, buffer);
+    }
+
+    void checkpoint_writer::add(uint64_t parent, uint32_t depth, const ntta_t& state, uint8_t pending) {
+        write_varint(parent, buffer);
+        write_varint(depth, buffer);
+        buffer.push_back(pending);
+        codec.encode(state, buffer);
+    }
+
+    void checkpoint_writer::add_solution(uint64_t index) {
+        write_varint(index, buffer);
+    }
+
+    void checkpoint_writer::add_passed_set(const compact_snapshot_t& snapshot) {
+        write_varint(static_cast<uint64_t>(snapshot.mode), buffer);
+        write_varint(snapshot.inserted, buffer);
+        write_varint(snapshot.words.size(), buffer);
+        // hashes and bits are close to random, so they are stored as fixed size little endian words
+        for(auto word : snapshot.words)
+            for(int shift = 0; shift < 64; shift += 8)
+                buffer.push_back(static_cast<uint8_t>(word >> shift));
+    }
+
+    void checkpoint_writer::save(const std::string& path) const {
+        auto tmp = path + ".tmp";
+        {
+            std::ofstream out{tmp, std::ios::binary | std::ios::trunc};
+            out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+            if(!out)
+                throw std::runtime_error(tmp + ": unable to write checkpoint");
+        }
+        if(std::rename(tmp.c_str(), path.c_str()) != 0)
+            throw std::runtime_error(path + ": unable to replace checkpoint");
+        spdlog::info("wrote checkpoint '{0}' ({1} bytes)", path, buffer.size());
+    }
+
+    checkpoint_reader::checkpoint_reader(const state_codec& codec, const std::string& path) : codec{codec}, cursor{} {
+        std::ifstream in{path, std::ios::binary};
+        if(!in)
+            throw std::runtime_error(path + ": unable to open checkpoint");
+        buffer.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+        cursor = buffer.data();
+        auto* end = buffer.data() + buffer.size();
+        if(buffer.size() < sizeof(magic) || !std::equal(std::begin(magic), std::end(magic), buffer.begin()))
+            throw std::runtime_error(path + ": not a checkpoint file");
+        cursor += sizeof(magic);
+        if(read_varint(cursor, end) != version)
+            throw std::runtime_error(path + ": unsupported checkpoint version");
+        if(read_varint(cursor, end) != codec.fingerprint())
+            throw std::runtime_error(path + ": checkpoint was created for a different model");
+        auto count = read_varint(cursor, end);
+        for(uint64_t i = 0; i < count; i++)
+            queries.push_back(read_string(cursor, end));
+    }
+
+    auto checkpoint_reader::get_queries() const -> const std::vector<std::string>& {
+        return queries;
+    }
+
+    auto checkpoint_reader::begin_section() -> size_t {
+        return read_varint(cursor, buffer.data() + buffer.size());
+    }
+
+    auto checkpoint_reader::next_entry() -> checkpoint_entry_t {
+        auto* end = buffer.data() + buffer.size();
+        auto parent = read_varint(cursor, end);
+        auto depth = static_cast<uint32_t>(read_varint(cursor, end));
+        if(cursor >= end)
+            throw std::out_of_range("unexpected end of checkpoint");
+        auto pending = *cursor++;
+        return {parent, depth, pending, codec.decode(cursor, end)};
+    }
+
+    auto checkpoint_reader::next_solution() -> uint64_t {
+        return read_varint(cursor, buffer.data() + buffer.size());
+    }
+
+    auto checkpoint_reader::next_passed_set() -> compact_snapshot_t {
+        auto* end = buffer.data() + buffer.size();
+        compact_snapshot_t result{};
+        auto mode = read_varint(cursor, end);
+        if(mode > static_cast<uint64_t>(storage_mode_t::bitstate))
+            throw std::out_of_range("unknown passed list storage mode in checkpoint");
+        result.mode = static_cast<storage_mode_t>(mode);
+        result.inserted = read_varint(cursor, end);
+        auto count = read_varint(cursor, end);
+        if(count > static_cast<uint64_t>(end - cursor) / 8)
+            throw std::out_of_range("unexpected end of checkpoint");
+        result.words.resize(count);
+        for(auto& word : result.words)
+            for(int shift = 0; shift < 64; shift += 8)
+                word |= static_cast<uint64_t>(*cursor++) << shift;
+        return result;
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_CHECKPOINT_H
+#define AALTITOAD_CHECKPOINT_H
+#include "search_limits.h"
+#include "state_codec.h"
+#include <string>
+#include <vector>
+
+namespace aaltitoad {
+    // SIGINT and SIGTERM only set a flag, such that searches can stop cleanly. A second signal terminates as usual
+    void install_interrupt_handlers();
+    auto is_interrupted() -> bool;
+
+    // Binary checkpoint of a search. The layout is:
+    //   magic, version, codec fingerprint, queries, passed entries, waiting entries, solutions, degraded passed set
+    // Parents are stored as 0 for no parent, otherwise the index + 1 of the parent in the passed list
+    struct checkpoint_entry_t {
+        uint64_t parent;
+        uint32_t depth;
+        uint8_t pending; // see pending_work_t
+        ntta_t state;
+    };
+
+    class checkpoint_writer {
+    public:
+        checkpoint_writer(const state_codec& codec, const std::vector<std::string>& queries);
+        void begin_section(size_t count); // passed, then waiting
+        void add(uint64_t parent, uint32_t depth, const ntta_t& state, uint8_t pending = 0);
+        void add_solution(uint64_t index); // same encoding as parents
+        void add_passed_set(const compact_snapshot_t& snapshot);
+        // writes to a temporary file first, such that an interrupted save does not destroy the previous checkpoint
+        void save(const std::string& path) const;
+    private:
+        const state_codec& codec;
+        bytes_t buffer{};
+    };
+
+    class checkpoint_reader {
+    public:
+        checkpoint_reader(const state_codec& codec, const std::string& path);
+        auto get_queries() const -> const std::vector<std::string>&;
+        auto begin_section() -> size_t; // passed, then waiting
+        auto next_entry() -> checkpoint_entry_t;
+        auto next_solution() -> uint64_t;
+        auto next_passed_set() -> compact_snapshot_t;
+    private:
+        const state_codec& codec;
+        bytes_t buffer{};
+        const uint8_t* cursor;
+        std::vector<std::string> queries{};
+    };
+}
+
+#endif //AALTITOAD_CHECKPOINT_H
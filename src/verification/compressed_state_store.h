@@ -0,0 +1,41 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_COMPRESSED_STATE_STORE_H
+#define AALTITOAD_COMPRESSED_STATE_STORE_H
+#include "ntta/tta.h"
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+namespace aaltitoad {
+    // Set of states that hands out dense indices, such that a search can keep parent links without keeping full states.
+    // See tree_compressed_store and packed_state_store
+    class compressed_state_store {
+    public:
+        using index_t = uint32_t;
+        virtual ~compressed_state_store() = default;
+        // the index of the state, and whether the state was not already stored
+        virtual auto insert(const ntta_t& state) -> std::pair<index_t, bool> = 0;
+        virtual auto find(const ntta_t& state) const -> std::optional<index_t> = 0;
+        virtual auto decode(index_t index) const -> ntta_t = 0;
+        virtual auto size() const -> size_t = 0;
+        virtual auto memory_bytes() const -> size_t = 0;
+    };
+}
+
+#endif //AALTITOAD_COMPRESSED_STATE_STORE_H
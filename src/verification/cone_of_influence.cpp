@@ -0,0 +1,98 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "cone_of_influence.h"
+#include "expr-wrappers/read-write-analysis.h"
+#include <spdlog/spdlog.h>
+#include <set>
+
+namespace aaltitoad {
+    void collect_locations(const ctl::syntax_tree_t& tree, std::set<std::string>& result) { // NOLINT(misc-no-recursion)
+        if(std::holds_alternative<ctl::location_t>(static_cast<const ctl::underlying_syntax_node_t&>(tree.node)))
+            result.insert(std::get<ctl::location_t>(static_cast<const ctl::underlying_syntax_node_t&>(tree.node)).location_name);
+        for(auto& c : tree.children())
+            collect_locations(c, result);
+    }
+
+    auto slice(const ntta_t& n, const std::vector<ctl::syntax_tree_t>& queries, slice_statistics_t& statistics) -> ntta_t {
+        struct component_sets_t { symbol_set_t reads{}, writes{}; };
+        std::map<std::string, component_sets_t> sets{};
+        for(auto& component : n.components) {
+            auto& s = sets[component.first];
+            for(auto& edge : component.second.graph->edges) {
+                s.reads |= edge.second.data.reads;
+                s.writes |= edge.second.data.writes;
+            }
+        }
+
+        symbol_set_t relevant_reads{}, relevant_writes{};
+        std::set<std::string> query_locations{}, relevant{};
+        for(auto& query : queries) {
+            relevant_reads |= get_read_set(query, *n.interner);
+            collect_locations(query, query_locations);
+        }
+        for(auto& component : n.components)
+            for(auto& location : query_locations)
+                if(component.second.graph->nodes.contains(location))
+                    relevant.insert(component.first);
+
+        // iterate until no more components are pulled into the cone
+        bool changed = true;
+        while(changed) {
+            changed = false;
+            for(auto& component : relevant) {
+                relevant_reads |= sets.at(component).reads;
+                relevant_writes |= sets.at(component).writes;
+            }
+            for(auto& s : sets) {
+                if(relevant.contains(s.first))
+                    continue;
+                if(s.second.writes.intersects(relevant_reads) || s.second.writes.intersects(relevant_writes)) {
+                    relevant.insert(s.first);
+                    changed = true;
+                }
+            }
+        }
+
+        auto keep = relevant_reads;
+        keep |= relevant_writes;
+        auto filter = [&n, &keep](const expr::symbol_table_t& symbols) {
+            expr::symbol_table_t result{};
+            for(auto& symbol : symbols)
+                if(keep.contains(n.interner->find(symbol.first).value()))
+                    result[symbol.first] = symbol.second;
+            return result;
+        };
+        ntta_t::tta_map_t components{};
+        for(auto& component : n.components)
+            if(relevant.contains(component.first))
+                components[component.first] = component.second;
+        // the graphs are shared with the input network, so the existing annotations and interner are reused
+        ntta_t result{filter(n.symbols), filter(n.external_symbols), components, n.interner};
+        for(auto& tocker : n.tockers)
+            result.add_tocker(tocker);
+
+        statistics.components_before = n.components.size();
+        statistics.components_after = result.components.size();
+        statistics.symbols_before = n.symbols.size() + n.external_symbols.size();
+        statistics.symbols_after = result.symbols.size() + result.external_symbols.size();
+        spdlog::info("cone-of-influence slicing removed {0}/{1} components and {2}/{3} symbols",
+                     statistics.components_before - statistics.components_after, statistics.components_before,
+                     statistics.symbols_before - statistics.symbols_after, statistics.symbols_before);
+        return result;
+    }
+}
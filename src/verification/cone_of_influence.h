@@ -0,0 +1,36 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_CONE_OF_INFLUENCE_H
+#define AALTITOAD_CONE_OF_INFLUENCE_H
+#include <ctl_syntax_tree.h>
+#include <ntta/tta.h>
+
+namespace aaltitoad {
+    struct slice_statistics_t {
+        size_t components_before{}, components_after{};
+        size_t symbols_before{}, symbols_after{};
+    };
+
+    // Removes the components and symbols that cannot influence the provided queries.
+    // A component is kept if a query mentions one of its locations, or if it writes a symbol that is read by a query
+    // or by a kept component. Components that write a symbol that a kept component also writes are kept as well,
+    // since conflicting updates restrict which tick choices are possible
+    auto slice(const ntta_t& n, const std::vector<ctl::syntax_tree_t>& queries, slice_statistics_t& statistics) -> ntta_t;
+}
+
+#endif //AALTITOAD_CONE_OF_INFLUENCE_H
@@ -0,0 +1,195 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "compiled_predicate.h"
+#include "expr-wrappers/read-write-analysis.h"
+#include "driver/evaluator.h"
+#include "operations/symbol-operator.h"
+#include <spdlog/spdlog.h>
+
+namespace aaltitoad {
+    compiled_predicate_t::compiled_predicate_t(const ctl::syntax_tree_t& query, const ntta_t& s0) {
+        compile(query, s0);
+        if(is_negated_query(get_query_kind(query)))
+            program.push_back({opcode_t::_not, 0});
+        spdlog::trace("compiled query into {0} instructions ({1} location atoms, {2} comparison atoms, {3} expression atoms)",
+                      program.size(), locations.size(), comparisons.size(), expressions.size());
+    }
+
+    auto compiled_predicate_t::size() const -> size_t {
+        return program.size();
+    }
+
+    auto compiled_predicate_t::get_support() const -> const support_t& {
+        return support;
+    }
+
+    auto compiled_predicate_t::is_affected_by(const state_delta_t& delta) const -> bool {
+        return support.symbols.intersects(delta.symbols) || support.components.intersects(delta.components);
+    }
+
+    void compiled_predicate_t::compile(const ctl::syntax_tree_t& tree, const ntta_t& s0) { // NOLINT(misc-no-recursion)
+        std::visit(ya::overload(
+                [&](const expr::syntax_tree_t& v) { compile(v, s0); },
+                [&](const expr::root_t&) { compile(tree.children()[0], s0); },
+                [&](const ctl::location_t& v) {
+                    location_atom_t atom{};
+                    for(auto& component : s0.components) {
+                        auto it = component.second.graph->nodes.find(v.location_name);
+                        if(it == component.second.graph->nodes.end())
+                            continue;
+                        atom.candidates.emplace_back(component.first, &(*it));
+                        support.components.insert(component.second.component_id);
+                    }
+                    if(atom.candidates.empty())
+                        spdlog::warn("location '{0}' does not exist in any component, the predicate is always false", v.location_name);
+                    program.push_back({opcode_t::location, static_cast<uint32_t>(locations.size())});
+                    locations.push_back(std::move(atom));
+                },
+                [&](const ctl::modal_t&) { compile(tree.children()[0], s0); },
+                [&](const ctl::quantifier_t&) { compile(tree.children()[0], s0); },
+                [&](const expr::operator_t& v) {
+                    for(auto& c : tree.children())
+                        compile(c, s0);
+                    emit(v);
+                },
+                [](auto&&) { throw std::logic_error("unsupported CTL syntax_tree node type"); }
+        ), static_cast<const ctl::underlying_syntax_node_t&>(tree.node));
+    }
+
+    void compiled_predicate_t::compile(const expr::syntax_tree_t& tree, const ntta_t& s0) { // NOLINT(misc-no-recursion)
+        auto is_connective = [](const expr::operator_type_t& t) {
+            switch(t) {
+                case expr::operator_type_t::_and:
+                case expr::operator_type_t::_or:
+                case expr::operator_type_t::_xor:
+                case expr::operator_type_t::_implies:
+                case expr::operator_type_t::_not: return true;
+                default: return false;
+            }
+        };
+        auto& node = static_cast<const expr::underlying_syntax_node_t&>(tree.node);
+        if(std::holds_alternative<expr::root_t>(node) && !tree.children().empty())
+            return compile(tree.children()[0], s0);
+        if(std::holds_alternative<expr::operator_t>(node) && is_connective(std::get<expr::operator_t>(node).operator_type)) {
+            for(auto& c : tree.children())
+                compile(c, s0);
+            return emit(std::get<expr::operator_t>(node));
+        }
+        if(try_compile_comparison(tree, s0))
+            return;
+        program.push_back({opcode_t::expression, static_cast<uint32_t>(expressions.size())});
+        expressions.push_back(tree);
+        support.symbols |= get_read_set(tree, *s0.interner);
+    }
+
+    void compiled_predicate_t::emit(const expr::operator_t& op) {
+        switch(op.operator_type) {
+            case expr::operator_type_t::_and:     program.push_back({opcode_t::_and, 0}); break;
+            case expr::operator_type_t::_or:      program.push_back({opcode_t::_or, 0}); break;
+            case expr::operator_type_t::_xor:     program.push_back({opcode_t::_xor, 0}); break;
+            case expr::operator_type_t::_implies: program.push_back({opcode_t::_implies, 0}); break;
+            case expr::operator_type_t::_not:     program.push_back({opcode_t::_not, 0}); break;
+            default: throw std::logic_error("not a valid CTL operator");
+        }
+    }
+
+    auto compiled_predicate_t::try_compile_comparison(const expr::syntax_tree_t& tree, const ntta_t& s0) -> bool {
+        auto& node = static_cast<const expr::underlying_syntax_node_t&>(tree.node);
+        if(!std::holds_alternative<expr::operator_t>(node) || tree.children().size() != 2)
+            return false;
+        auto op = std::get<expr::operator_t>(node).operator_type;
+        auto& lhs = static_cast<const expr::underlying_syntax_node_t&>(tree.children()[0].node);
+        auto& rhs = static_cast<const expr::underlying_syntax_node_t&>(tree.children()[1].node);
+        auto flipped = false;
+        const expr::identifier_t* identifier;
+        const expr::symbol_value_t* literal;
+        if(std::holds_alternative<expr::identifier_t>(lhs) && std::holds_alternative<expr::symbol_value_t>(rhs)) {
+            identifier = &std::get<expr::identifier_t>(lhs);
+            literal = &std::get<expr::symbol_value_t>(rhs);
+        } else if(std::holds_alternative<expr::symbol_value_t>(lhs) && std::holds_alternative<expr::identifier_t>(rhs)) {
+            identifier = &std::get<expr::identifier_t>(rhs);
+            literal = &std::get<expr::symbol_value_t>(lhs);
+            flipped = true;
+        } else
+            return false;
+        switch(op) {
+            case expr::operator_type_t::_lt: if(flipped) op = expr::operator_type_t::_gt; break;
+            case expr::operator_type_t::_le: if(flipped) op = expr::operator_type_t::_ge; break;
+            case expr::operator_type_t::_gt: if(flipped) op = expr::operator_type_t::_lt; break;
+            case expr::operator_type_t::_ge: if(flipped) op = expr::operator_type_t::_le; break;
+            case expr::operator_type_t::_ee:
+            case expr::operator_type_t::_ne: break;
+            default: return false;
+        }
+        auto is_external = !s0.symbols.contains(identifier->ident);
+        if(is_external && !s0.external_symbols.contains(identifier->ident))
+            return false; // let the evaluator report the unknown identifier
+        support.symbols.insert(s0.interner->find(identifier->ident).value());
+        program.push_back({opcode_t::comparison, static_cast<uint32_t>(comparisons.size())});
+        comparisons.push_back({identifier->ident, is_external, op, *literal});
+        return true;
+    }
+
+    auto compiled_predicate_t::evaluate(const comparison_atom_t& atom, const ntta_t& state) const -> bool {
+        auto& table = atom.is_external ? state.external_symbols : state.symbols;
+        auto& value = table.find(atom.symbol)->second;
+        switch(atom.op) {
+            case expr::operator_type_t::_lt: return std::get<bool>(lt_(value, atom.value));
+            case expr::operator_type_t::_le: return std::get<bool>(le_(value, atom.value));
+            case expr::operator_type_t::_gt: return std::get<bool>(gt_(value, atom.value));
+            case expr::operator_type_t::_ge: return std::get<bool>(ge_(value, atom.value));
+            case expr::operator_type_t::_ee: return std::get<bool>(ee_(value, atom.value));
+            case expr::operator_type_t::_ne: return std::get<bool>(ne_(value, atom.value));
+            default: throw std::logic_error("not a valid comparison operator");
+        }
+    }
+
+    auto compiled_predicate_t::evaluate(const location_atom_t& atom, const ntta_t& state) const -> bool {
+        for(auto& candidate : atom.candidates) {
+            auto it = state.components.find(candidate.first);
+            if(it != state.components.end() && &(*it->second.current_location) == candidate.second)
+                return true;
+        }
+        return false;
+    }
+
+    auto compiled_predicate_t::evaluate(const ntta_t& state) const -> bool {
+        std::vector<bool> stack{};
+        stack.reserve(program.size());
+        auto pop = [&stack]() { auto v = stack.back(); stack.pop_back(); return v; };
+        for(auto& instruction : program) {
+            switch(instruction.opcode) {
+                case opcode_t::location:   stack.push_back(evaluate(locations[instruction.operand], state)); break;
+                case opcode_t::comparison: stack.push_back(evaluate(comparisons[instruction.operand], state)); break;
+                case opcode_t::expression: {
+                    expr::evaluator e{{state.symbols, state.external_symbols}, expr::symbol_operator{}};
+                    stack.push_back(std::get<bool>(e.evaluate(expressions[instruction.operand])));
+                    break;
+                }
+                case opcode_t::_not: stack.push_back(!pop()); break;
+                case opcode_t::_and:     { auto b = pop(); auto a = pop(); stack.push_back(a && b); break; }
+                case opcode_t::_or:      { auto b = pop(); auto a = pop(); stack.push_back(a || b); break; }
+                case opcode_t::_xor:     { auto b = pop(); auto a = pop(); stack.push_back(a != b); break; }
+                case opcode_t::_implies: { auto b = pop(); auto a = pop(); stack.push_back(!a || b); break; }
+            }
+        }
+        if(stack.size() != 1)
+            throw std::logic_error("malformed compiled predicate");
+        return stack.back();
+    }
+}
@@ -0,0 +1,80 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_COMPILED_PREDICATE_H
+#define AALTITOAD_COMPILED_PREDICATE_H
+#include <ctl_syntax_tree.h>
+#include <ntta/tta.h>
+#include <verification/ctl/ctl_sat.h>
+#include <verification/search_metadata.h>
+#include <vector>
+
+namespace aaltitoad {
+    // A CTL state predicate compiled into a flat postfix program of atoms and boolean connectives.
+    // Modal and quantifier nodes are stripped the same way is_satisfied does, except that the
+    // predicates of universal queries (A G p, A F p) are negated, such that they are satisfied by counterexamples
+    class compiled_predicate_t {
+    public:
+        compiled_predicate_t() = default;
+        compiled_predicate_t(const ctl::syntax_tree_t& query, const ntta_t& s0);
+        auto evaluate(const ntta_t& state) const -> bool;
+        auto size() const -> size_t;
+        // the components and symbols that the predicate reads
+        struct support_t {
+            symbol_set_t symbols{};
+            symbol_set_t components{};
+        };
+        auto get_support() const -> const support_t&;
+        // if a transition does not touch the support, the predicate has the same value as in the parent state
+        auto is_affected_by(const state_delta_t& delta) const -> bool;
+
+    private:
+        enum class opcode_t {
+            location, comparison, expression, _and, _or, _xor, _implies, _not
+        };
+        struct instruction_t {
+            opcode_t opcode;
+            uint32_t operand;
+        };
+        // a ctl::location_t is true when any of the components is in the named location
+        struct location_atom_t {
+            std::vector<std::pair<std::string, const void*>> candidates;
+        };
+        // <symbol> <op> <literal>
+        struct comparison_atom_t {
+            std::string symbol;
+            bool is_external;
+            expr::operator_type_t op;
+            expr::symbol_value_t value;
+        };
+
+        std::vector<instruction_t> program{};
+        std::vector<location_atom_t> locations{};
+        std::vector<comparison_atom_t> comparisons{};
+        std::vector<expr::syntax_tree_t> expressions{};
+        support_t support{};
+
+        void compile(const ctl::syntax_tree_t& tree, const ntta_t& s0);
+        void compile(const expr::syntax_tree_t& tree, const ntta_t& s0);
+        void emit(const expr::operator_t& op);
+        auto try_compile_comparison(const expr::syntax_tree_t& tree, const ntta_t& s0) -> bool;
+        auto evaluate(const comparison_atom_t& atom, const ntta_t& state) const -> bool;
+        auto evaluate(const location_atom_t& atom, const ntta_t& state) const -> bool;
+    };
+}
+
+#endif //AALTITOAD_COMPILED_PREDICATE_H
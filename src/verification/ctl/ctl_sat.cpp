@@ -66,5 +66,30 @@ namespace aaltitoad {
                               [](auto&&) -> bool { throw std::logic_error("unsupported CTL syntax_tree node type"); }
                           ), static_cast<const ctl::underlying_syntax_node_t&>(ast.node));
     }
+
+    auto get_query_kind(const ctl::syntax_tree_t& query) -> query_kind_t { // NOLINT(misc-no-recursion)
+        auto& node = static_cast<const ctl::underlying_syntax_node_t&>(query.node);
+        if(std::holds_alternative<expr::root_t>(node) && !query.children().empty())
+            return get_query_kind(query.children()[0]);
+        if(!std::holds_alternative<ctl::modal_t>(node) || query.children().empty())
+            return query_kind_t::reachability;
+        auto& quantifier = static_cast<const ctl::underlying_syntax_node_t&>(query.children()[0].node);
+        if(!std::holds_alternative<ctl::quantifier_t>(quantifier))
+            return query_kind_t::reachability;
+        auto modal = std::get<ctl::modal_t>(node).operator_type;
+        switch(std::get<ctl::quantifier_t>(quantifier).operator_type) {
+            case ctl::quantifier_op_t::G: return modal == ctl::modal_op_t::A ? query_kind_t::safety : query_kind_t::possibly_always;
+            case ctl::quantifier_op_t::F: return modal == ctl::modal_op_t::A ? query_kind_t::eventually : query_kind_t::reachability;
+            default: return query_kind_t::reachability;
+        }
+    }
+
+    auto is_liveness_query(const query_kind_t& kind) -> bool {
+        return kind == query_kind_t::possibly_always || kind == query_kind_t::eventually;
+    }
+
+    auto is_negated_query(const query_kind_t& kind) -> bool {
+        return kind == query_kind_t::safety || kind == query_kind_t::eventually;
+    }
 }
 
@@ -22,6 +22,16 @@
 
 namespace aaltitoad {
     auto is_satisfied(const ctl::syntax_tree_t& ast, const ntta_t& state) -> bool;
+
+    enum class query_kind_t {
+        reachability,     // E F p - satisfied when a p-state is found
+        safety,           // A G p - violated when a !p-state is found
+        possibly_always,  // E G p - satisfied when a lasso or deadlocking path of p-states is found
+        eventually        // A F p - violated when a lasso or deadlocking path of !p-states is found
+    };
+    auto is_liveness_query(const query_kind_t& kind) -> bool;
+    auto is_negated_query(const query_kind_t& kind) -> bool;
+    auto get_query_kind(const ctl::syntax_tree_t& query) -> query_kind_t;
 }
 
 #endif //AALTITOAD_CTL_SAT_H
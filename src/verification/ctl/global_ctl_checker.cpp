@@ -0,0 +1,264 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "global_ctl_checker.h"
+#include "compiled_predicate.h"
+#include <spdlog/spdlog.h>
+#include <timer>
+#include <queue>
+
+namespace aaltitoad {
+    global_ctl_checker::global_ctl_checker(const ntta_t& s0) {
+        ya::timer<int> t{};
+        explore(s0);
+        build_predecessors();
+        spdlog::debug("explored {0} states and {1} transitions in {2}ms", state_count(), transition_count(), t.milliseconds_elapsed());
+    }
+
+    auto global_ctl_checker::state_count() const -> size_t {
+        return states.size();
+    }
+
+    auto global_ctl_checker::transition_count() const -> size_t {
+        return successors.size();
+    }
+
+    void global_ctl_checker::explore(const ntta_t& s0) {
+        // states in the tock phase may still let the environment change the external symbols before ticking
+        std::vector<bool> is_tock_phase{};
+        std::unordered_multimap<size_t, state_id_t> index{};
+        auto intern = [&](const ntta_t& s, bool tock_phase) -> state_id_t {
+            auto key = ya::hash_combine(std::hash<ntta_t>{}(s), tock_phase);
+            auto range = index.equal_range(key);
+            for(auto it = range.first; it != range.second; it++)
+                if(is_tock_phase[it->second] == tock_phase && states[it->second] == s)
+                    return it->second;
+            auto id = static_cast<state_id_t>(states.size());
+            states.push_back(s);
+            is_tock_phase.push_back(tock_phase);
+            index.insert({key, id});
+            return id;
+        };
+        intern(s0, true);
+        successor_offsets = {0};
+        for(state_id_t i = 0; i < states.size(); i++) {
+            std::vector<state_id_t> next{};
+            auto s = states[i]; // copy, since interning may reallocate the state vector
+            auto tocks = is_tock_phase[i] ? s.tock() : std::vector<expr::symbol_table_t>{};
+            for(auto& so : tocks)
+                next.push_back(intern(s + so, false));
+            // the initial state is also ticked directly, mirroring the forward reachability search
+            if(tocks.empty() || i == 0)
+                for(auto& si : s.tick())
+                    next.push_back(intern(s + si, true));
+            if(next.empty())
+                next.push_back(i);
+            std::sort(next.begin(), next.end());
+            next.erase(std::unique(next.begin(), next.end()), next.end());
+            successors.insert(successors.end(), next.begin(), next.end());
+            successor_offsets.push_back(static_cast<state_id_t>(successors.size()));
+        }
+    }
+
+    void global_ctl_checker::build_predecessors() {
+        predecessor_offsets.assign(states.size() + 1, 0);
+        for(auto& t : successors)
+            predecessor_offsets[t + 1]++;
+        for(size_t i = 0; i < states.size(); i++)
+            predecessor_offsets[i + 1] += predecessor_offsets[i];
+        predecessors.resize(successors.size());
+        auto fill = std::vector<state_id_t>{predecessor_offsets.begin(), predecessor_offsets.end() - 1};
+        for(state_id_t s = 0; s < states.size(); s++)
+            for(auto e = successor_offsets[s]; e < successor_offsets[s + 1]; e++)
+                predecessors[fill[successors[e]]++] = s;
+    }
+
+    auto global_ctl_checker::is_satisfied(const ctl::syntax_tree_t& query) -> bool {
+        return sat(query)[0];
+    }
+
+    auto global_ctl_checker::get_satisfying_states(const ctl::syntax_tree_t& formula) -> state_set_t {
+        return sat(formula);
+    }
+
+    auto global_ctl_checker::sat(const ctl::syntax_tree_t& formula) -> state_set_t { // NOLINT(misc-no-recursion)
+        if(is_state_formula(formula))
+            return sat_atomic(formula);
+        return std::visit(ya::overload(
+                [&](const expr::root_t&) -> state_set_t { return sat(formula.children()[0]); },
+                [&](const ctl::modal_t& v) -> state_set_t { return sat_modal(v.operator_type, formula.children()[0]); },
+                [&](const expr::operator_t& v) -> state_set_t {
+                    if(v.operator_type == expr::operator_type_t::_not)
+                        return negate(sat(formula.children()[0]));
+                    auto a = sat(formula.children()[0]);
+                    auto b = sat(formula.children()[1]);
+                    for(size_t i = 0; i < a.size(); i++) {
+                        switch(v.operator_type) {
+                            case expr::operator_type_t::_and:     a[i] = a[i] && b[i]; break;
+                            case expr::operator_type_t::_or:      a[i] = a[i] || b[i]; break;
+                            case expr::operator_type_t::_xor:     a[i] = a[i] != b[i]; break;
+                            case expr::operator_type_t::_implies: a[i] = !a[i] || b[i]; break;
+                            default: throw std::logic_error("not a valid CTL operator");
+                        }
+                    }
+                    return a;
+                },
+                [](auto&&) -> state_set_t { throw std::logic_error("quantifiers must be preceded by a modal (A or E)"); }
+        ), static_cast<const ctl::underlying_syntax_node_t&>(formula.node));
+    }
+
+    auto global_ctl_checker::sat_modal(const ctl::modal_op_t& modal, const ctl::syntax_tree_t& quantifier) -> state_set_t { // NOLINT(misc-no-recursion)
+        if(!std::holds_alternative<ctl::quantifier_t>(static_cast<const ctl::underlying_syntax_node_t&>(quantifier.node)))
+            throw std::logic_error("modals (A or E) must be followed by a quantifier");
+        auto q = std::get<ctl::quantifier_t>(static_cast<const ctl::underlying_syntax_node_t&>(quantifier.node)).operator_type;
+        auto is_binary = q == ctl::quantifier_op_t::U || q == ctl::quantifier_op_t::W;
+        if(quantifier.children().size() != (is_binary ? 2 : 1))
+            throw std::logic_error("wrong number of operands for CTL quantifier");
+        auto all = state_set_t(states.size(), true);
+        auto phi = sat(quantifier.children()[0]);
+        auto psi = is_binary ? sat(quantifier.children()[1]) : state_set_t{};
+        auto e = modal == ctl::modal_op_t::E;
+        switch(q) {
+            case ctl::quantifier_op_t::X: return e ? pre_exists(phi) : pre_forall(phi);
+            case ctl::quantifier_op_t::F: return e ? exists_until(all, phi) : forall_until(all, phi);
+            case ctl::quantifier_op_t::G: return e ? exists_always(phi) : negate(exists_until(all, negate(phi)));
+            case ctl::quantifier_op_t::U: return e ? exists_until(phi, psi) : forall_until(phi, psi);
+            case ctl::quantifier_op_t::W: {
+                if(!e) {
+                    // A[phi W psi] = !E[!psi U (!phi && !psi)]
+                    auto not_psi = negate(psi);
+                    auto target = negate(phi);
+                    for(size_t i = 0; i < target.size(); i++)
+                        target[i] = target[i] && not_psi[i];
+                    return negate(exists_until(not_psi, target));
+                }
+                // E[phi W psi] = E[phi U psi] || E G phi
+                auto result = exists_until(phi, psi);
+                auto always = exists_always(phi);
+                for(size_t i = 0; i < result.size(); i++)
+                    result[i] = result[i] || always[i];
+                return result;
+            }
+            default: throw std::logic_error("not a valid CTL quantifier");
+        }
+    }
+
+    auto global_ctl_checker::sat_atomic(const ctl::syntax_tree_t& formula) -> state_set_t {
+        compiled_predicate_t predicate{formula, states[0]};
+        state_set_t result(states.size(), false);
+        for(size_t i = 0; i < states.size(); i++)
+            result[i] = predicate.evaluate(states[i]);
+        return result;
+    }
+
+    auto global_ctl_checker::pre_exists(const state_set_t& target) const -> state_set_t {
+        state_set_t result(states.size(), false);
+        for(size_t s = 0; s < states.size(); s++)
+            for(auto e = successor_offsets[s]; e < successor_offsets[s + 1] && !result[s]; e++)
+                result[s] = target[successors[e]];
+        return result;
+    }
+
+    auto global_ctl_checker::pre_forall(const state_set_t& target) const -> state_set_t {
+        state_set_t result(states.size(), true);
+        for(size_t s = 0; s < states.size(); s++)
+            for(auto e = successor_offsets[s]; e < successor_offsets[s + 1] && result[s]; e++)
+                result[s] = target[successors[e]];
+        return result;
+    }
+
+    auto global_ctl_checker::exists_until(const state_set_t& phi, const state_set_t& psi) const -> state_set_t {
+        auto result = psi;
+        std::queue<state_id_t> worklist{};
+        for(state_id_t s = 0; s < states.size(); s++)
+            if(result[s])
+                worklist.push(s);
+        while(!worklist.empty()) {
+            auto s = worklist.front(); worklist.pop();
+            for(auto e = predecessor_offsets[s]; e < predecessor_offsets[s + 1]; e++) {
+                auto p = predecessors[e];
+                if(result[p] || !phi[p])
+                    continue;
+                result[p] = true;
+                worklist.push(p);
+            }
+        }
+        return result;
+    }
+
+    auto global_ctl_checker::forall_until(const state_set_t& phi, const state_set_t& psi) const -> state_set_t {
+        auto result = psi;
+        std::vector<state_id_t> remaining(states.size());
+        std::queue<state_id_t> worklist{};
+        for(state_id_t s = 0; s < states.size(); s++) {
+            remaining[s] = successor_offsets[s + 1] - successor_offsets[s];
+            if(result[s])
+                worklist.push(s);
+        }
+        while(!worklist.empty()) {
+            auto s = worklist.front(); worklist.pop();
+            for(auto e = predecessor_offsets[s]; e < predecessor_offsets[s + 1]; e++) {
+                auto p = predecessors[e];
+                if(result[p] || --remaining[p] > 0 || !phi[p])
+                    continue;
+                result[p] = true;
+                worklist.push(p);
+            }
+        }
+        return result;
+    }
+
+    auto global_ctl_checker::exists_always(const state_set_t& phi) const -> state_set_t {
+        auto result = phi;
+        std::vector<state_id_t> remaining(states.size(), 0);
+        std::queue<state_id_t> worklist{};
+        for(state_id_t s = 0; s < states.size(); s++) {
+            if(!result[s])
+                continue;
+            for(auto e = successor_offsets[s]; e < successor_offsets[s + 1]; e++)
+                if(phi[successors[e]])
+                    remaining[s]++;
+            if(remaining[s] == 0) {
+                result[s] = false;
+                worklist.push(s);
+            }
+        }
+        while(!worklist.empty()) {
+            auto s = worklist.front(); worklist.pop();
+            for(auto e = predecessor_offsets[s]; e < predecessor_offsets[s + 1]; e++) {
+                auto p = predecessors[e];
+                if(!result[p] || --remaining[p] > 0)
+                    continue;
+                result[p] = false;
+                worklist.push(p);
+            }
+        }
+        return result;
+    }
+
+    auto global_ctl_checker::negate(state_set_t s) -> state_set_t {
+        s.flip();
+        return s;
+    }
+
+    auto global_ctl_checker::is_state_formula(const ctl::syntax_tree_t& formula) -> bool { // NOLINT(misc-no-recursion)
+        auto& node = static_cast<const ctl::underlying_syntax_node_t&>(formula.node);
+        if(std::holds_alternative<ctl::modal_t>(node) || std::holds_alternative<ctl::quantifier_t>(node))
+            return false;
+        return std::all_of(formula.children().begin(), formula.children().end(), is_state_formula);
+    }
+}
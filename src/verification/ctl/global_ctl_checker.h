@@ -0,0 +1,61 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_GLOBAL_CTL_CHECKER_H
+#define AALTITOAD_GLOBAL_CTL_CHECKER_H
+#include <ctl_syntax_tree.h>
+#include <ntta/tta.h>
+#include <unordered_map>
+#include <vector>
+
+namespace aaltitoad {
+    // Explicit-state CTL model checker. The reachable state graph is enumerated once and stored in
+    // compressed sparse row form, then arbitrarily nested CTL formulas are evaluated by backward fixpoint
+    // iteration over state sets. Deadlocking states are treated as if they had a self-loop
+    class global_ctl_checker {
+    public:
+        using state_id_t = uint32_t;
+        using state_set_t = std::vector<bool>;
+        explicit global_ctl_checker(const ntta_t& s0);
+        auto is_satisfied(const ctl::syntax_tree_t& query) -> bool;
+        auto get_satisfying_states(const ctl::syntax_tree_t& formula) -> state_set_t;
+        auto state_count() const -> size_t;
+        auto transition_count() const -> size_t;
+
+    private:
+        std::vector<ntta_t> states{};
+        std::vector<state_id_t> successor_offsets{};   // CSR: successors of i are successors[successor_offsets[i] .. successor_offsets[i+1]]
+        std::vector<state_id_t> successors{};
+        std::vector<state_id_t> predecessor_offsets{};
+        std::vector<state_id_t> predecessors{};
+
+        void explore(const ntta_t& s0);
+        void build_predecessors();
+        auto sat(const ctl::syntax_tree_t& formula) -> state_set_t;
+        auto sat_modal(const ctl::modal_op_t& modal, const ctl::syntax_tree_t& quantifier) -> state_set_t;
+        auto sat_atomic(const ctl::syntax_tree_t& formula) -> state_set_t;
+        auto pre_exists(const state_set_t& target) const -> state_set_t;
+        auto pre_forall(const state_set_t& target) const -> state_set_t;
+        auto exists_until(const state_set_t& phi, const state_set_t& psi) const -> state_set_t;
+        auto forall_until(const state_set_t& phi, const state_set_t& psi) const -> state_set_t;
+        auto exists_always(const state_set_t& phi) const -> state_set_t;
+        static auto negate(state_set_t s) -> state_set_t;
+        static auto is_state_formula(const ctl::syntax_tree_t& formula) -> bool;
+    };
+}
+
+#endif //AALTITOAD_GLOBAL_CTL_CHECKER_H
@@ -0,0 +1,124 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "dead_variable_reduction.h"
+#include "expr-wrappers/read-write-analysis.h"
+#include <spdlog/spdlog.h>
+
+namespace aaltitoad {
+    dead_variable_reducer::dead_variable_reducer(const ntta_t& s0, const std::vector<ctl::syntax_tree_t>& queries) {
+        auto& interner = *s0.interner;
+        symbol_set_t query_reads{};
+        for(auto& query : queries)
+            query_reads |= get_read_set(query, interner);
+
+        // find the components reading each symbol
+        std::unordered_map<symbol_id_t, std::vector<std::string>> readers{};
+        for(auto& component : s0.components) {
+            symbol_set_t reads{};
+            for(auto& edge : component.second.graph->edges)
+                reads |= edge.second.data.reads;
+            for(auto& id : reads.to_vector())
+                readers[id].push_back(component.first);
+        }
+
+        auto clock_index = expr::symbol_value_t{expr::clock_t{0}}.index();
+        std::unordered_map<std::string, symbol_set_t> owned{};
+        for(auto& symbol : s0.symbols) {
+            auto id = interner.find(symbol.first).value();
+            if(query_reads.contains(id) || symbol.second.index() == clock_index)
+                continue;
+            auto it = readers.find(id);
+            if(it == readers.end())
+                never_read.emplace_back(symbol.first, symbol.second);
+            else if(it->second.size() == 1)
+                owned[it->second[0]].insert(id);
+            else
+                continue;
+            candidates++;
+        }
+
+        for(auto& component : s0.components) {
+            auto o = owned.find(component.first);
+            if(o == owned.end())
+                continue;
+            // backwards may-liveness over the location graph: live(l) = U_{l -e-> l'} reads(e) | (live(l') - writes(e))
+            std::unordered_map<const void*, symbol_set_t> live{};
+            bool changed = true;
+            while(changed) {
+                changed = false;
+                for(auto& node : component.second.graph->nodes) {
+                    symbol_set_t l{};
+                    for(auto& edge : node.second.outgoing_edges) {
+                        auto target = live[&(*edge->second.target)];
+                        target -= edge->second.data.writes;
+                        l |= edge->second.data.reads;
+                        l |= target;
+                    }
+                    auto& current = live[&node];
+                    if(!(current == l)) {
+                        current = l;
+                        changed = true;
+                    }
+                }
+            }
+            std::unordered_map<const void*, reset_list_t> dead{};
+            for(auto& node : component.second.graph->nodes) {
+                reset_list_t resets{};
+                for(auto& id : o->second.to_vector())
+                    if(!live[&node].contains(id))
+                        resets.emplace_back(interner.name(id), s0.symbols.at(interner.name(id)));
+                if(!resets.empty())
+                    dead[&node] = std::move(resets);
+            }
+            if(!dead.empty())
+                dead_per_location.emplace_back(component.first, std::move(dead));
+        }
+        spdlog::debug("dead variable reduction: {0} candidate symbols ({1} never read)", candidates, never_read.size());
+    }
+
+    void dead_variable_reducer::reduce(ntta_t& state) const {
+        reduce(state, nullptr);
+    }
+
+    void dead_variable_reducer::reduce(ntta_t& state, ntta_t::undo_t& undo) const {
+        reduce(state, &undo);
+    }
+
+    void dead_variable_reducer::reduce(ntta_t& state, ntta_t::undo_t* undo) const {
+        auto reset = [&state, undo](const std::pair<std::string, expr::symbol_value_t>& symbol) {
+            auto it = state.symbols.find(symbol.first);
+            if(undo != nullptr)
+                undo->record(it);
+            it->second = symbol.second;
+        };
+        for(auto& symbol : never_read)
+            reset(symbol);
+        for(auto& component : dead_per_location) {
+            auto& location = state.components.at(component.first).current_location;
+            auto resets = component.second.find(&(*location));
+            if(resets == component.second.end())
+                continue;
+            for(auto& symbol : resets->second)
+                reset(symbol);
+        }
+    }
+
+    auto dead_variable_reducer::candidate_count() const -> size_t {
+        return candidates;
+    }
+}
@@ -0,0 +1,46 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_DEAD_VARIABLE_REDUCTION_H
+#define AALTITOAD_DEAD_VARIABLE_REDUCTION_H
+#include <ctl_syntax_tree.h>
+#include <ntta/tta.h>
+#include <unordered_map>
+
+namespace aaltitoad {
+    // Resets internal symbols to their initial value when they will be overwritten before they are read again.
+    // Liveness is computed per location of the only component that reads the symbol. Symbols that are read by
+    // several components, read by a query, external or clocks are never reset
+    class dead_variable_reducer {
+    public:
+        dead_variable_reducer(const ntta_t& s0, const std::vector<ctl::syntax_tree_t>& queries);
+        void reduce(ntta_t& state) const;
+        // the reset values are recorded in undo, see ntta_t::apply(const state_change_t&, undo_t&)
+        void reduce(ntta_t& state, ntta_t::undo_t& undo) const;
+        auto candidate_count() const -> size_t;
+
+    private:
+        using reset_list_t = std::vector<std::pair<std::string, expr::symbol_value_t>>;
+        std::vector<std::pair<std::string, std::unordered_map<const void*, reset_list_t>>> dead_per_location{};
+        reset_list_t never_read{};
+        size_t candidates{};
+
+        void reduce(ntta_t& state, ntta_t::undo_t* undo) const;
+    };
+}
+
+#endif //AALTITOAD_DEAD_VARIABLE_REDUCTION_H
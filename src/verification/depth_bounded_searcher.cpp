@@ -0,0 +1,194 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "depth_bounded_searcher.h"
+#include "checkpoint.h"
+#include <spdlog/spdlog.h>
+
+namespace aaltitoad {
+    bounded_state_cache::bounded_state_cache(size_t capacity) : capacity{capacity} {
+
+    }
+
+    auto bounded_state_cache::visit(const encoded_state_t& state, unsigned int budget) -> bool {
+        if(capacity == 0)
+            return false;
+        auto it = entries.find(state);
+        if(it != entries.end()) {
+            recency.splice(recency.begin(), recency, it->second.recency);
+            if(it->second.budget >= budget)
+                return true;
+            it->second.budget = budget;
+            return false;
+        }
+        if(entries.size() >= capacity) {
+            entries.erase(entries.find(*recency.back()));
+            recency.pop_back();
+        }
+        auto inserted = entries.emplace(state, entry_t{budget, {}}).first;
+        recency.push_front(&inserted->first); // references to elements survive rehashing
+        inserted->second.recency = recency.begin();
+        return false;
+    }
+
+    auto bounded_state_cache::size() const -> size_t {
+        return entries.size();
+    }
+
+    void bounded_state_cache::clear() {
+        recency.clear();
+        entries.clear();
+    }
+
+    depth_bounded_searcher::depth_bounded_searcher(const config_t& config) : config{config}, cache{config.cache_size} {
+
+    }
+
+    auto depth_bounded_searcher::search(const ntta_t& s0, const std::vector<ctl::syntax_tree_t>& q) -> solutions_t {
+        solutions = {}; P = {}; cache.clear(); explored = 0; truncated = false; interrupted = false;
+        codec.emplace(s0);
+        for(auto& query : q) {
+            solutions.emplace_back(query, compiled_predicate_t{query, s0});
+            if(is_liveness_query(solutions.back().kind))
+                throw std::logic_error("depth_bounded_searcher only supports E F and A G queries");
+        }
+        auto bound = config.iterative_deepening ? std::min(1u, config.max_depth) : config.max_depth;
+        if(!check_satisfactions(s0)) {
+            while(true) {
+                auto done = search_bounded(s0, bound);
+                spdlog::debug("depth bound {0}: {1} states explored, {2} states cached", bound, explored, cache.size());
+                if(done || interrupted || !truncated || !config.iterative_deepening || bound >= config.max_depth)
+                    break;
+                bound++;
+            }
+        }
+        if(interrupted && !all_solved())
+            spdlog::warn("search interrupted at depth bound {0} ({1} states explored)", bound, explored);
+        else if(truncated && !all_solved())
+            spdlog::warn("search was truncated at depth {0}, queries without solutions may still have one deeper in the state-space", bound);
+        spdlog::info("[{0}/{1}] queries with solutions ({2} states explored)",
+                     std::count_if(solutions.begin(), solutions.end(), [](const query_solution_t& s){ return s.solution.has_value(); }),
+                     solutions.size(), explored);
+        return solutions;
+    }
+
+    auto depth_bounded_searcher::is_complete() const -> bool {
+        return !truncated && !interrupted;
+    }
+
+    auto depth_bounded_searcher::search_bounded(const ntta_t& s0, unsigned int bound) -> bool {
+        stack.clear(); on_path.clear(); truncated = false;
+        push(s0, std::hash<ntta_t>{}(s0), bound);
+        while(!stack.empty()) {
+            if(all_solved())
+                return true;
+            if(is_interrupted()) {
+                interrupted = true;
+                return false;
+            }
+            auto& frame = stack.back();
+            if(frame.next >= frame.successors.size()) {
+                pop();
+                continue;
+            }
+            auto sn = std::move(frame.successors[frame.next++]);
+            auto hash = std::hash<ntta_t>{}(sn);
+            if(is_on_path(hash, sn))
+                continue;
+            // the depth of sn is the current stack size, so this is what is left of the bound below it
+            if(cache.visit(codec->encode_delta(sn), bound - static_cast<unsigned int>(stack.size())))
+                continue;
+            explored++;
+            if(check_satisfactions(sn))
+                return true;
+            push(sn, hash, bound);
+        }
+        return all_solved();
+    }
+
+    auto depth_bounded_searcher::check_satisfactions(const ntta_t& state) -> bool {
+        for(auto& solution : solutions)
+            if(!solution.solution.has_value() && solution.predicate.evaluate(state))
+                record(solution, state);
+        return all_solved();
+    }
+
+    void depth_bounded_searcher::record(query_solution_t& solution, const ntta_t& last) {
+        // the path is only materialized when a solution is found
+        std::optional<solution_t> parent{};
+        uint32_t depth = 0;
+        for(auto& frame : stack)
+            parent = P.add(parent, frame.state, {{}, depth++});
+        solution.solution = P.add(parent, last, {{}, depth});
+        spdlog::debug("found solution at depth {0}", stack.size());
+    }
+
+    auto depth_bounded_searcher::is_on_path(size_t hash, const ntta_t& state) const -> bool {
+        auto range = on_path.equal_range(hash);
+        for(auto it = range.first; it != range.second; it++)
+            if(stack[it->second].state == state)
+                return true;
+        return false;
+    }
+
+    void depth_bounded_searcher::push(const ntta_t& state, size_t hash, unsigned int bound) {
+        on_path.emplace(hash, stack.size());
+        stack.push_back({state, hash, {}, 0});
+        if(stack.size() > bound) {
+            truncated = true;
+            return;
+        }
+        auto successors = expand(state, stack.size() == 1);
+        stack.back().successors = std::move(successors);
+    }
+
+    void depth_bounded_searcher::pop() {
+        auto range = on_path.equal_range(stack.back().hash);
+        for(auto it = range.first; it != range.second; it++) {
+            if(it->second == stack.size() - 1) {
+                on_path.erase(it);
+                break;
+            }
+        }
+        stack.pop_back();
+    }
+
+    auto depth_bounded_searcher::all_solved() const -> bool {
+        return std::all_of(solutions.begin(), solutions.end(), [](const query_solution_t& s){ return s.solution.has_value(); });
+    }
+
+    auto depth_bounded_searcher::expand(const ntta_t& state, bool is_root) -> std::vector<ntta_t> {
+        std::vector<ntta_t> result{};
+        auto s = state;
+        for(auto& si : s.tick()) {
+            auto sn = state + si;
+            auto sn_tocks = sn.tock();
+            if(sn_tocks.empty()) {
+                result.push_back(std::move(sn));
+                continue;
+            }
+            // the tick-space state is part of the trace, but does not count as a step of its own
+            check_satisfactions(sn);
+            for(auto& so : sn_tocks)
+                result.push_back(sn + so);
+        }
+        if(is_root)
+            for(auto& l : state.tock())
+                result.push_back(state + l);
+        return result;
+    }
+}
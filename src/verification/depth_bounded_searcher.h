@@ -0,0 +1,93 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_DEPTH_BOUNDED_SEARCHER_H
+#define AALTITOAD_DEPTH_BOUNDED_SEARCHER_H
+#include "forward_reachability.h"
+#include "state_codec.h"
+#include <limits>
+#include <list>
+#include <unordered_map>
+
+namespace aaltitoad {
+    // Least-recently-used map from encoded states to the largest remaining depth budget a state was explored with.
+    // States are compared exactly, so an evicted state is only explored again and never wrongly pruned
+    class bounded_state_cache {
+    public:
+        explicit bounded_state_cache(size_t capacity);
+        // true if the state was already explored with at least the provided budget, otherwise the budget is recorded
+        auto visit(const encoded_state_t& state, unsigned int budget) -> bool;
+        auto size() const -> size_t;
+        void clear();
+    private:
+        struct entry_t {
+            unsigned int budget;
+            std::list<const encoded_state_t*>::iterator recency;
+        };
+        size_t capacity;
+        std::list<const encoded_state_t*> recency{}; // keys of entries, most recently visited first
+        std::unordered_map<encoded_state_t, entry_t> entries{};
+    };
+
+    // Depth-first search for E F and A G queries that only keeps the current path and a bounded state cache in memory.
+    // With iterative deepening, the depth bound starts at 1 and grows by one until all queries are solved,
+    // the max depth is reached or an iteration explored the full state-space without hitting the bound
+    class depth_bounded_searcher {
+    public:
+        using solution_t = forward_reachability_searcher::solution_t;
+        using query_solution_t = forward_reachability_searcher::query_solution_t;
+        using solutions_t = forward_reachability_searcher::solutions_t;
+        struct config_t {
+            unsigned int max_depth = std::numeric_limits<unsigned int>::max();
+            bool iterative_deepening = false;
+            size_t cache_size = 1u << 20;
+        };
+        explicit depth_bounded_searcher(const config_t& config);
+        auto search(const ntta_t& s0, const std::vector<ctl::syntax_tree_t>& q) -> solutions_t;
+        // false if the last search hit the depth bound or was interrupted, so queries without a solution are undecided
+        auto is_complete() const -> bool;
+
+    private:
+        struct frame_t {
+            ntta_t state;
+            size_t hash;
+            std::vector<ntta_t> successors;
+            size_t next;
+        };
+        config_t config;
+        forward_reachability_searcher::state_map_t P{}; // only holds the traces of solutions
+        bounded_state_cache cache;
+        std::optional<state_codec> codec{};
+        std::vector<frame_t> stack{};
+        std::unordered_multimap<size_t, size_t> on_path{};
+        solutions_t solutions{};
+        bool truncated{};
+        bool interrupted{};
+        size_t explored{};
+
+        auto search_bounded(const ntta_t& s0, unsigned int bound) -> bool;
+        auto check_satisfactions(const ntta_t& state) -> bool;
+        void record(query_solution_t& solution, const ntta_t& last);
+        auto is_on_path(size_t hash, const ntta_t& state) const -> bool;
+        void push(const ntta_t& state, size_t hash, unsigned int bound);
+        void pop();
+        auto all_solved() const -> bool;
+        auto expand(const ntta_t& state, bool is_root) -> std::vector<ntta_t>;
+    };
+}
+
+#endif //AALTITOAD_DEPTH_BOUNDED_SEARCHER_H
@@ -0,0 +1,197 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "domain_inference.h"
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <limits>
+#include <spdlog/spdlog.h>
+
+namespace aaltitoad {
+    namespace {
+        constexpr int64_t int_min = std::numeric_limits<int>::min();
+        constexpr int64_t int_max = std::numeric_limits<int>::max();
+        constexpr int max_rounds = 16;
+
+        auto join(const domain_t& a, const domain_t& b) -> domain_t {
+            return {std::min(a.min, b.min), std::max(a.max, b.max)};
+        }
+
+        auto fits_int(const domain_t& d) -> bool {
+            return d.min >= int_min && d.max <= int_max;
+        }
+
+        auto is_int(const expr::symbol_value_t& v) -> bool {
+            return std::holds_alternative<int>(static_cast<const expr::underlying_symbol_value_t&>(v));
+        }
+
+        // narrows the domains of the symbols compared against literals in the top-level conjunction of a guard
+        void narrow(const expr::syntax_tree_t& guard, domain_map_t& domains) { // NOLINT(misc-no-recursion)
+            auto& node = static_cast<const expr::underlying_syntax_node_t&>(guard.node);
+            if(std::holds_alternative<expr::root_t>(node)) {
+                if(!guard.children().empty())
+                    narrow(guard.children()[0], domains);
+                return;
+            }
+            if(!std::holds_alternative<expr::operator_t>(node) || guard.children().size() != 2)
+                return;
+            auto op = std::get<expr::operator_t>(node).operator_type;
+            if(op == expr::operator_type_t::_and) {
+                narrow(guard.children()[0], domains);
+                narrow(guard.children()[1], domains);
+                return;
+            }
+            auto& lhs = static_cast<const expr::underlying_syntax_node_t&>(guard.children()[0].node);
+            auto& rhs = static_cast<const expr::underlying_syntax_node_t&>(guard.children()[1].node);
+            const expr::identifier_t* identifier;
+            const expr::symbol_value_t* literal;
+            if(std::holds_alternative<expr::identifier_t>(lhs) && std::holds_alternative<expr::symbol_value_t>(rhs)) {
+                identifier = &std::get<expr::identifier_t>(lhs);
+                literal = &std::get<expr::symbol_value_t>(rhs);
+            } else if(std::holds_alternative<expr::symbol_value_t>(lhs) && std::holds_alternative<expr::identifier_t>(rhs)) {
+                identifier = &std::get<expr::identifier_t>(rhs);
+                literal = &std::get<expr::symbol_value_t>(lhs);
+                switch(op) {
+                    case expr::operator_type_t::_lt: op = expr::operator_type_t::_gt; break;
+                    case expr::operator_type_t::_le: op = expr::operator_type_t::_ge; break;
+                    case expr::operator_type_t::_gt: op = expr::operator_type_t::_lt; break;
+                    case expr::operator_type_t::_ge: op = expr::operator_type_t::_le; break;
+                    default: break;
+                }
+            } else
+                return;
+            auto it = domains.find(identifier->ident);
+            if(it == domains.end() || !is_int(*literal))
+                return;
+            auto c = static_cast<int64_t>(std::get<int>(static_cast<const expr::underlying_symbol_value_t&>(*literal)));
+            auto& d = it->second;
+            switch(op) {
+                case expr::operator_type_t::_lt: d.max = std::min(d.max, c - 1); break;
+                case expr::operator_type_t::_le: d.max = std::min(d.max, c); break;
+                case expr::operator_type_t::_gt: d.min = std::max(d.min, c + 1); break;
+                case expr::operator_type_t::_ge: d.min = std::max(d.min, c); break;
+                case expr::operator_type_t::_ee: d.min = std::max(d.min, c); d.max = std::min(d.max, c); break;
+                default: break;
+            }
+        }
+
+        // interval of an integer expression, or nothing if it can not be bounded
+        auto evaluate(const expr::syntax_tree_t& e, const domain_map_t& domains) -> std::optional<domain_t> { // NOLINT(misc-no-recursion)
+            return std::visit(ya::overload(
+                    [&](const expr::symbol_value_t& v) -> std::optional<domain_t> {
+                        if(!is_int(v))
+                            return {};
+                        auto i = static_cast<int64_t>(std::get<int>(static_cast<const expr::underlying_symbol_value_t&>(v)));
+                        return domain_t{i, i};
+                    },
+                    [&](const expr::identifier_t& v) -> std::optional<domain_t> {
+                        auto it = domains.find(v.ident);
+                        if(it == domains.end())
+                            return {};
+                        return it->second;
+                    },
+                    [&](const expr::root_t&) -> std::optional<domain_t> {
+                        if(e.children().empty())
+                            return {};
+                        return evaluate(e.children()[0], domains);
+                    },
+                    [&](const expr::operator_t& o) -> std::optional<domain_t> {
+                        auto a = evaluate(e.children()[0], domains);
+                        if(!a.has_value())
+                            return {};
+                        if(e.children().size() == 1) {
+                            if(o.operator_type == expr::operator_type_t::_minus)
+                                return domain_t{-a->max, -a->min};
+                            return {};
+                        }
+                        auto b = evaluate(e.children()[1], domains);
+                        if(!b.has_value())
+                            return {};
+                        switch(o.operator_type) {
+                            case expr::operator_type_t::_plus:  return domain_t{a->min + b->min, a->max + b->max};
+                            case expr::operator_type_t::_minus: return domain_t{a->min - b->max, a->max - b->min};
+                            case expr::operator_type_t::_star: {
+                                auto p = {a->min * b->min, a->min * b->max, a->max * b->min, a->max * b->max};
+                                return domain_t{std::min(p), std::max(p)};
+                            }
+                            case expr::operator_type_t::_percent: {
+                                // the result is smaller than the divisor and has the sign of the dividend
+                                auto m = std::max(std::abs(b->min), std::abs(b->max));
+                                if(m == 0)
+                                    return {};
+                                return domain_t{a->min < 0 ? -(m - 1) : 0, a->max > 0 ? m - 1 : 0};
+                            }
+                            default: return {};
+                        }
+                    },
+                    [](auto&&) -> std::optional<domain_t> { return {}; }
+            ), static_cast<const expr::underlying_syntax_node_t&>(e.node));
+        }
+    }
+
+    auto domain_t::width() const -> uint32_t {
+        return static_cast<uint32_t>(std::bit_width(static_cast<uint64_t>(max - min)));
+    }
+
+    auto infer_domains(const ntta_t& n) -> domain_map_t {
+        domain_map_t domains{};
+        for(auto& symbol : n.symbols) {
+            if(!is_int(symbol.second))
+                continue;
+            auto v = static_cast<int64_t>(std::get<int>(static_cast<const expr::underlying_symbol_value_t&>(symbol.second)));
+            domains[symbol.first] = {v, v};
+        }
+        for(int round = 0; ; round++) {
+            auto widening = round >= max_rounds; // from now on, symbols that still grow are unbounded
+            auto changed = false;
+            auto next = domains;
+            for(auto& component : n.components) {
+                for(auto& edge : component.second.graph->edges) {
+                    auto narrowed = domains;
+                    narrow(edge.second.data.guard, narrowed);
+                    if(std::any_of(narrowed.begin(), narrowed.end(), [](const auto& d){ return d.second.min > d.second.max; }))
+                        continue; // the guard can never be satisfied
+                    for(auto& update : edge.second.data.updates) {
+                        auto it = next.find(update.first);
+                        if(it == next.end())
+                            continue;
+                        auto value = evaluate(update.second, narrowed);
+                        if(!value.has_value() || !fits_int(value.value())) {
+                            next.erase(it);
+                            changed = true;
+                            continue;
+                        }
+                        auto joined = join(it->second, value.value());
+                        if(joined.min == it->second.min && joined.max == it->second.max)
+                            continue;
+                        if(widening)
+                            next.erase(it);
+                        else
+                            it->second = joined;
+                        changed = true;
+                    }
+                }
+            }
+            domains = std::move(next);
+            if(!changed)
+                break;
+        }
+        spdlog::debug("inferred bounded domains for {0} of {1} symbols", domains.size(), n.symbols.size());
+        return domains;
+    }
+}
@@ -0,0 +1,44 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_DOMAIN_INFERENCE_H
+#define AALTITOAD_DOMAIN_INFERENCE_H
+#include <ntta/tta.h>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace aaltitoad {
+    // Inclusive interval of the values an integer symbol can take
+    struct domain_t {
+        int64_t min{};
+        int64_t max{};
+        auto width() const -> uint32_t; // bits needed to store a value as an offset from min
+    };
+    // symbols without an entry are unbounded
+    using domain_map_t = std::unordered_map<std::string, domain_t>;
+
+    // Interval analysis of the internal integer symbols. Starting from the initial values, the intervals of all
+    // update expressions are joined into the domains until a fixed point is reached. Guard conjuncts of the form
+    // <symbol> <op> <literal> narrow the domains of the edge first. Symbols that are still growing after a few
+    // rounds, or that leave the int range, are unbounded. External symbols are written by tockers and are never bounded.
+    // The analysis does not see internal symbols written by tockers, so users of the domains must check values
+    auto infer_domains(const ntta_t& n) -> domain_map_t;
+}
+
+#endif //AALTITOAD_DOMAIN_INFERENCE_H
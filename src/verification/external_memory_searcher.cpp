@@ -0,0 +1,317 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "external_memory_searcher.h"
+#include "checkpoint.h"
+#include <fstream>
+#include <queue>
+#include <spdlog/spdlog.h>
+
+namespace aaltitoad {
+    namespace {
+        // Run files are sequences of sorted records, each stored as the length of the prefix it shares with the
+        // previous record, the length of the rest and the rest itself. Sorted encoded states share long prefixes
+        class run_writer {
+        public:
+            explicit run_writer(const std::filesystem::path& path) : out{path, std::ios::binary | std::ios::trunc} {
+                if(!out)
+                    throw std::runtime_error(path.string() + ": unable to create run file");
+            }
+            void write(const bytes_t& record) {
+                auto n = std::min(previous.size(), record.size());
+                size_t shared = 0;
+                while(shared < n && previous[shared] == record[shared])
+                    shared++;
+                chunk.clear();
+                write_varint(shared, chunk);
+                write_varint(record.size() - shared, chunk);
+                chunk.insert(chunk.end(), record.begin() + static_cast<std::ptrdiff_t>(shared), record.end());
+                out.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+                if(!out)
+                    throw std::runtime_error("unable to write run file");
+                previous = record;
+            }
+        private:
+            std::ofstream out;
+            bytes_t previous{}, chunk{};
+        };
+
+        class run_reader {
+        public:
+            explicit run_reader(const std::filesystem::path& path) : in{path, std::ios::binary} {
+                if(!in)
+                    throw std::runtime_error(path.string() + ": unable to open run file");
+                advance();
+            }
+            auto done() const -> bool {
+                return exhausted;
+            }
+            auto current() const -> const bytes_t& {
+                return record;
+            }
+            void advance() {
+                uint64_t shared, suffix;
+                if(!read_varint(shared)) {
+                    exhausted = true;
+                    return;
+                }
+                if(!read_varint(suffix) || shared > record.size())
+                    throw std::runtime_error("corrupt run file");
+                record.resize(shared + suffix);
+                in.read(reinterpret_cast<char*>(record.data() + shared), static_cast<std::streamsize>(suffix));
+                if(static_cast<uint64_t>(in.gcount()) != suffix)
+                    throw std::runtime_error("corrupt run file");
+            }
+        private:
+            auto read_varint(uint64_t& value) -> bool {
+                value = 0;
+                for(int shift = 0; shift < 64; shift += 7) {
+                    auto c = in.get();
+                    if(c == std::char_traits<char>::eof()) {
+                        if(shift == 0)
+                            return false;
+                        throw std::runtime_error("corrupt run file");
+                    }
+                    value |= static_cast<uint64_t>(c & 0x7f) << shift;
+                    if((c & 0x80) == 0)
+                        return true;
+                }
+                throw std::runtime_error("corrupt run file");
+            }
+            std::ifstream in;
+            bytes_t record{};
+            bool exhausted{};
+        };
+    }
+
+    external_memory_searcher::external_memory_searcher(config_t config) : config{std::move(config)} {
+        auto unique = std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+        directory = this->config.scratch_directory / ("aaltitoad-" + unique);
+    }
+
+    external_memory_searcher::~external_memory_searcher() {
+        std::error_code ec{};
+        std::filesystem::remove_all(directory, ec);
+    }
+
+    auto external_memory_searcher::search(const ntta_t& s0, const std::vector<ctl::syntax_tree_t>& q) -> solutions_t {
+        solutions = {}; P = {}; layers.clear(); visited.clear(); run_count = 0; interrupted = false;
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        codec.emplace(s0);
+        for(auto& query : q) {
+            solutions.emplace_back(query, compiled_predicate_t{query, s0});
+            if(is_liveness_query(solutions.back().kind))
+                throw std::logic_error("external_memory_searcher only supports E F and A G queries");
+        }
+        std::vector<bytes_t> initial{codec->encode(s0)};
+        layers.push_back(write_run(initial));
+        initial.push_back(codec->encode(s0));
+        visited = write_run(initial);
+        size_t total = 1;
+        if(!check_satisfactions(s0, [&s0]{ return trace_t{{s0, 0}}; })) {
+            for(size_t depth = 1; !all_solved(); depth++) {
+                auto runs = expand_layer(depth, s0);
+                auto count = all_solved() || interrupted ? 0 : merge_layer(runs, depth, s0);
+                for(auto& run : runs)
+                    std::filesystem::remove(run);
+                if(interrupted) {
+                    spdlog::warn("search interrupted at depth {0} ({1} states explored)", depth, total);
+                    break;
+                }
+                spdlog::debug("layer {0} has {1} new states from {2} runs", depth, count, runs.size());
+                total += count;
+                if(count == 0)
+                    break;
+            }
+        }
+        spdlog::info("[{0}/{1}] queries with solutions ({2} states explored in {3} layers)",
+                     std::count_if(solutions.begin(), solutions.end(), [](const query_solution_t& s){ return s.solution.has_value(); }),
+                     solutions.size(), total, layers.size());
+        return solutions;
+    }
+
+    auto external_memory_searcher::is_complete() const -> bool {
+        return !interrupted;
+    }
+
+    auto external_memory_searcher::poll_interrupt() -> bool {
+        if(is_interrupted())
+            interrupted = true;
+        return interrupted;
+    }
+
+    auto external_memory_searcher::expand_layer(size_t depth, const ntta_t& s0) -> std::vector<std::filesystem::path> {
+        std::vector<std::filesystem::path> runs{};
+        std::vector<bytes_t> buffer{};
+        size_t used = 0;
+        for(run_reader reader{layers[depth - 1]}; !reader.done(); reader.advance()) {
+            if(poll_interrupt())
+                return runs;
+            auto state = codec->decode(reader.current());
+            for(auto& successor : expand(state, depth == 1)) {
+                // intermediate tick-space states are not stored, so they are checked while their parent is known
+                if(successor.tick_state.has_value()) {
+                    auto& tick_state = successor.tick_state.value();
+                    auto trace = [&]{ auto t = reconstruct(state, depth - 1, s0); t.emplace_back(tick_state, depth); return t; };
+                    if(check_satisfactions(tick_state, trace))
+                        return runs;
+                }
+                buffer.push_back(codec->encode(successor.state));
+                used += buffer.back().capacity() + sizeof(bytes_t);
+                if(used >= config.ram_budget) {
+                    runs.push_back(write_run(buffer));
+                    used = 0;
+                }
+            }
+        }
+        if(!buffer.empty())
+            runs.push_back(write_run(buffer));
+        return runs;
+    }
+
+    auto external_memory_searcher::write_run(std::vector<bytes_t>& buffer) -> std::filesystem::path {
+        std::sort(buffer.begin(), buffer.end());
+        buffer.erase(std::unique(buffer.begin(), buffer.end()), buffer.end());
+        auto path = directory / ("run-" + std::to_string(run_count++));
+        run_writer writer{path};
+        for(auto& record : buffer)
+            writer.write(record);
+        buffer.clear();
+        return path;
+    }
+
+    auto external_memory_searcher::merge_layer(const std::vector<std::filesystem::path>& runs, size_t depth, const ntta_t& s0) -> size_t {
+        // the new runs are merged with each other, and joined with the sorted file of all previously visited states.
+        // A record that is also visited is a duplicate, and the new layer is folded into the next visited file,
+        // such that the number of open files does not grow with the depth
+        std::vector<run_reader> readers{};
+        readers.reserve(runs.size());
+        for(auto& run : runs)
+            readers.emplace_back(run);
+        auto greater = [&readers](size_t a, size_t b){ return readers[b].current() < readers[a].current(); };
+        std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap{greater};
+        for(size_t i = 0; i < readers.size(); i++)
+            if(!readers[i].done())
+                heap.push(i);
+
+        auto path = directory / ("layer-" + std::to_string(depth));
+        auto next_visited = directory / ("visited-" + std::to_string(depth));
+        size_t count = 0;
+        {
+            run_writer writer{path};
+            run_writer visited_writer{next_visited};
+            run_reader visited_reader{visited};
+            bytes_t current{};
+            while(!heap.empty() && !all_solved() && !poll_interrupt()) {
+                current = readers[heap.top()].current();
+                while(!heap.empty() && readers[heap.top()].current() == current) {
+                    auto i = heap.top();
+                    heap.pop();
+                    readers[i].advance();
+                    if(!readers[i].done())
+                        heap.push(i);
+                }
+                for(; !visited_reader.done() && visited_reader.current() < current; visited_reader.advance())
+                    visited_writer.write(visited_reader.current());
+                if(!visited_reader.done() && visited_reader.current() == current)
+                    continue;
+                writer.write(current);
+                visited_writer.write(current);
+                count++;
+                auto state = codec->decode(current);
+                check_satisfactions(state, [&]{ return reconstruct(state, depth, s0); });
+            }
+            // a search that stops here does not read the visited states again
+            for(; !visited_reader.done() && !all_solved() && !interrupted; visited_reader.advance())
+                visited_writer.write(visited_reader.current());
+        }
+        std::filesystem::remove(visited);
+        visited = next_visited;
+        layers.push_back(path);
+        return count;
+    }
+
+    auto external_memory_searcher::check_satisfactions(const ntta_t& state, const std::function<trace_t()>& trace) -> bool {
+        std::optional<trace_t> t{};
+        for(auto& solution : solutions) {
+            if(solution.solution.has_value() || !solution.predicate.evaluate(state))
+                continue;
+            if(!t.has_value())
+                t = trace();
+            record(solution, t.value());
+        }
+        return all_solved();
+    }
+
+    auto external_memory_searcher::reconstruct(const ntta_t& target, size_t depth, const ntta_t& s0) -> trace_t {
+        // walk the layers backwards, looking for a state that has the current state as a successor
+        trace_t trace{{target, static_cast<uint32_t>(depth)}};
+        auto current = codec->encode(target);
+        for(auto d = depth; d > 0; d--) {
+            auto found = false;
+            for(run_reader reader{layers[d - 1]}; !reader.done() && !found; reader.advance()) {
+                auto state = codec->decode(reader.current());
+                for(auto& successor : expand(state, d == 1)) {
+                    if(codec->encode(successor.state) != current)
+                        continue;
+                    if(successor.tick_state.has_value())
+                        trace.emplace_back(successor.tick_state.value(), d);
+                    trace.emplace_back(state, d - 1);
+                    current = reader.current();
+                    found = true;
+                    break;
+                }
+            }
+            if(!found)
+                throw std::logic_error("unable to reconstruct trace, the layer files are inconsistent");
+        }
+        std::reverse(trace.begin(), trace.end());
+        return trace;
+    }
+
+    void external_memory_searcher::record(query_solution_t& solution, const trace_t& trace) {
+        std::optional<solution_t> parent{};
+        for(auto& state : trace)
+            parent = P.add(parent, state.first, {{}, state.second});
+        solution.solution = parent;
+        spdlog::debug("found solution with a trace of {0} states", trace.size());
+    }
+
+    auto external_memory_searcher::all_solved() const -> bool {
+        return std::all_of(solutions.begin(), solutions.end(), [](const query_solution_t& s){ return s.solution.has_value(); });
+    }
+
+    auto external_memory_searcher::expand(const ntta_t& state, bool is_root) -> std::vector<successor_t> {
+        std::vector<successor_t> result{};
+        auto s = state;
+        for(auto& si : s.tick()) {
+            auto sn = state + si;
+            auto sn_tocks = sn.tock();
+            if(sn_tocks.empty()) {
+                result.push_back({{}, std::move(sn)});
+                continue;
+            }
+            for(auto& so : sn_tocks)
+                result.push_back({sn, sn + so});
+        }
+        if(is_root)
+            for(auto& l : state.tock())
+                result.push_back({{}, state + l});
+        return result;
+    }
+}
@@ -0,0 +1,75 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_EXTERNAL_MEMORY_SEARCHER_H
+#define AALTITOAD_EXTERNAL_MEMORY_SEARCHER_H
+#include "forward_reachability.h"
+#include "state_codec.h"
+#include <filesystem>
+#include <functional>
+
+namespace aaltitoad {
+    // Breadth-first search for E F and A G queries with delayed duplicate detection.
+    // Every layer is stored as a sorted file of encoded states in the scratch directory. Successors are buffered
+    // until the RAM budget is used up and then written as sorted runs. Once a layer is expanded, the runs are merged
+    // with a sorted file of all visited states, which removes duplicates by streaming instead of hash probes into a
+    // passed list.
+    // No parent links are stored, traces are reconstructed by re-expanding the previous layers backwards
+    class external_memory_searcher {
+    public:
+        using solution_t = forward_reachability_searcher::solution_t;
+        using query_solution_t = forward_reachability_searcher::query_solution_t;
+        using solutions_t = forward_reachability_searcher::solutions_t;
+        struct config_t {
+            std::filesystem::path scratch_directory;
+            size_t ram_budget = size_t{1} << 30; // bytes
+        };
+        explicit external_memory_searcher(config_t config);
+        ~external_memory_searcher();
+        auto search(const ntta_t& s0, const std::vector<ctl::syntax_tree_t>& q) -> solutions_t;
+        // false if the last search was interrupted, so queries without a solution are undecided
+        auto is_complete() const -> bool;
+
+    private:
+        struct successor_t {
+            std::optional<ntta_t> tick_state; // the intermediate tick-space state, if tock changes were applied
+            ntta_t state;
+        };
+        using trace_t = std::vector<std::pair<ntta_t, uint32_t>>; // states with their layer
+        config_t config;
+        std::filesystem::path directory{};
+        std::optional<state_codec> codec{};
+        forward_reachability_searcher::state_map_t P{}; // only holds the traces of solutions
+        solutions_t solutions{};
+        std::vector<std::filesystem::path> layers{};
+        std::filesystem::path visited{}; // all states of the merged layers, sorted
+        size_t run_count{};
+        bool interrupted{};
+
+        auto expand_layer(size_t depth, const ntta_t& s0) -> std::vector<std::filesystem::path>;
+        auto merge_layer(const std::vector<std::filesystem::path>& runs, size_t depth, const ntta_t& s0) -> size_t;
+        auto write_run(std::vector<bytes_t>& buffer) -> std::filesystem::path;
+        auto poll_interrupt() -> bool;
+        auto check_satisfactions(const ntta_t& state, const std::function<trace_t()>& trace) -> bool;
+        auto reconstruct(const ntta_t& target, size_t depth, const ntta_t& s0) -> trace_t;
+        void record(query_solution_t& solution, const trace_t& trace);
+        auto all_solved() const -> bool;
+        static auto expand(const ntta_t& state, bool is_root) -> std::vector<successor_t>;
+    };
+}
+
+#endif //AALTITOAD_EXTERNAL_MEMORY_SEARCHER_H
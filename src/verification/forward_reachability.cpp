@@ -19,75 +19,437 @@
 #include "spdlog/spdlog.h"
 #include "verification/ctl/ctl_sat.h"
 #include "verification/traceable_multimap.h"
+#include "verification/query_heuristic.h"
+#include "verification/checkpoint.h"
+#include "util/memory_usage.h"
+#include <sstream>
+#include <unordered_map>
 
 namespace aaltitoad {
     forward_reachability_searcher::forward_reachability_searcher(const aaltitoad::pick_strategy& strategy)
-     : W{}, P{}, solutions{}, strategy{strategy} {
+     : solutions{}, strategy{strategy} {
 
     }
 
+    void forward_reachability_searcher::set_dead_variable_reduction(bool enabled) {
+        reduce_dead_variables = enabled;
+    }
+
+    void forward_reachability_searcher::set_shortest_trace(bool enabled) {
+        shortest_trace = enabled;
+    }
+
+    void forward_reachability_searcher::set_checkpoint(const std::string& path, std::chrono::minutes interval) {
+        checkpoint = {path, interval};
+    }
+
+    void forward_reachability_searcher::set_resume(const std::string& path) {
+        resume_path = path;
+    }
+
+    void forward_reachability_searcher::set_huge_pages(bool enabled) {
+        state_arena.set_huge_pages(enabled);
+    }
+
+    void forward_reachability_searcher::set_tree_compression(bool enabled) {
+        tree_compression = enabled;
+    }
+
+    void forward_reachability_searcher::set_packed_states(bool enabled) {
+        packed_states = enabled;
+    }
+
+    void forward_reachability_searcher::canonicalize(ntta_t& s) const {
+        if(reducer.has_value())
+            reducer->reduce(s);
+    }
+
+    void forward_reachability_searcher::canonicalize(ntta_t& s, ntta_t::undo_t& undo) const {
+        if(reducer.has_value())
+            reducer->reduce(s, undo);
+    }
+
     auto forward_reachability_searcher::is_reachable(const ntta_t& s0, const compiled_query_t& q) -> solutions_t {
         return is_reachable(s0, std::vector{q});
     }
 
     auto forward_reachability_searcher::is_reachable(const aaltitoad::ntta_t& s0, const std::vector<compiled_query_t>& q) -> solutions_t {
-        // TODO: Catch SIGTERM (ctrl-c) and write statistics (info)
-        W = {s0}; P = {}; solutions = empty_solution_set(q);
+        // P keeps its arena when assigned to, and holds no nodes afterwards
+        W = {}; P = {}; state_arena.release(); scratch_arena.release();
+        solutions = empty_solution_set(q, s0); skipped_checks = 0;
+        statistics = {}; compact.clear(); limit_checks = 0;
+        codec = std::make_shared<const state_codec>(s0);
+        if(strategy == pick_strategy::best_first) {
+            auto heuristic = std::make_shared<query_distance_heuristic>(q, s0);
+            W.set_heuristic([heuristic, c = codec](const encoded_state_t& s){ return heuristic->score(c->decode_delta(s)); });
+        }
+        reducer.reset();
+        if(reduce_dead_variables)
+            reducer.emplace(s0, q);
+        last_checkpoint = std::chrono::steady_clock::now();
+        compressed.reset(); compressed_parents.clear();
+        if(tree_compression || packed_states) {
+            auto option = packed_states ? "--packed-states" : "--tree-compression";
+            if(tree_compression && packed_states)
+                spdlog::warn("--packed-states takes precedence over --tree-compression");
+            if(shortest_trace)
+                spdlog::warn("{0} is not supported with --shortest-trace and is ignored", option);
+            else if(packed_states)
+                compressed = std::make_unique<packed_state_store>(s0);
+            else
+                compressed = std::make_unique<tree_compressed_store>(s0);
+            if(checkpoint.has_value())
+                spdlog::warn("checkpoints do not include {0} states, a resumed search explores them again", option);
+        }
+        if(resume_path.has_value()) {
+            if(shortest_trace)
+                spdlog::warn("resumed searches continue with the waiting list, --shortest-trace is ignored");
+            restore_checkpoint();
+            if(std::all_of(solutions.begin(), solutions.end(), [](const query_solution_t& sol){ return sol.solution.has_value(); }))
+                return get_results();
+            return search_waiting_list();
+        }
         auto s0_it = P.add(s0);
+        // every state in P has been checked, so unsolved queries are known to be false in any parent state
+        if(check_satisfactions(s0_it))
+            return get_results();
+        if(shortest_trace) {
+            std::vector<solution_t> layer{s0_it};
+            for(auto& l : s0.tock()) {
+                auto sp = s0 + l;
+                canonicalize(sp);
+                if(P.contains(sp))
+                    continue;
+                layer.push_back(P.add(s0_it, sp, {state_delta_t::from(l, *s0.interner)}));
+                if(check_satisfactions(layer.back()))
+                    return get_results();
+            }
+            return search_layered(layer);
+        }
+        add_waiting({}, s0, {}, pending_tick);
+        std::optional<uint32_t> s0_root{};
+        if(compressed)
+            s0_root = store({}, s0, s0_it->second.metadata).root;
         for(auto& l : s0.tock()) {
             auto sp = s0 + l;
+            canonicalize(sp);
             if(!P.contains(sp))
-                W.add_if_not_contains(s0_it, sp);
+                add_waiting(s0_it, sp, {state_delta_t::from(l, *s0.interner), 0, s0_root}, pending_tick);
         }
+        return search_waiting_list();
+    }
+
+    auto forward_reachability_searcher::search_waiting_list() -> solutions_t {
+        ntta_t::undo_t undo{};
         while(!W.empty()) {
+            if(should_stop() || !enforce_limits(true))
+                return get_results();
             /// Select the next state to search
-            auto s = W.pop(strategy);
-            auto s_it = P.add(s.parent, s.data);
-            if(check_satisfactions(s_it))
+            auto popped = pop_waiting();
+            memory::scratch_scope scratch{scratch_arena};
+            auto& s = popped.first;
+            statistics.explored++;
+            statistics.max_depth = std::max(statistics.max_depth, s.metadata.depth);
+            // in degraded storage modes, states are only put in P when they solve a query,
+            // and successors link to the nearest stored ancestor instead
+            auto s_stored = store(s.parent, s.data, s.metadata);
+            auto s_ancestor = s_stored.it.has_value() ? s_stored.it : s.parent;
+            auto s_root = s_stored.root.has_value() ? s_stored.root : s.metadata.compressed_parent;
+            if(check_satisfactions(s.data, s.metadata, [&]{ return s_stored.it.has_value() ? s_stored.it.value() : materialize(s.parent, s.data, s.metadata); }))
                 return get_results();
+            /// Tick successors are tocked when popped, such that states that are never popped skip the tock
+            // successors are applied to s in place and reverted, W only keeps an encoding of the new ones
+            if(popped.second & pending_tock) {
+                auto s_tocks = s.data.tock();
+                /// if nothing interesting is possible, the state is searched as a tick-space state
+                if(!s_tocks.empty()) {
+                    /// Add tock-space states to W
+                    spdlog::trace("{0} tock values available", s_tocks.size());
+                    for(auto& so : s_tocks) {
+                        s.data.apply(so, undo);
+                        canonicalize(s.data, undo);
+                        if(!is_passed(s.data))
+                            add_waiting(s_ancestor, s.data, {state_delta_t::from(so, *s.data.interner), s.metadata.depth, s_root}, pending_tick);
+                        s.data.revert(undo);
+                    }
+                    // the state may also be waiting as a tock successor, which must still be ticked
+                    if(!(popped.second & pending_tick))
+                        continue;
+                }
+            }
             /// Add successors
             for(auto& si : s.data.tick()) {
-                auto sn = s.data + si;
-                if(P.contains(sn))
-                    continue;
-                /// Calculate interesting tock changes
-                auto sn_tocks = sn.tock();
-                /// if nothing interesting is possible, just add tick-space state to W
-                if(sn_tocks.empty()) {
-                    W.add_if_not_contains(s_it, sn);
-                    continue;
+                s.data.apply(si, undo);
+                canonicalize(s.data, undo);
+                if(!is_passed(s.data))
+                    add_waiting(s_ancestor, s.data, {state_delta_t::from(si), s.metadata.depth + 1, s_root}, pending_tock);
+                s.data.revert(undo);
+            }
+        }
+        /// Searched through all of the reachable state-space from s0
+        spdlog::debug("end of reachable state-space");
+        return get_results();
+    }
+
+    auto forward_reachability_searcher::store(const std::optional<solution_t>& parent, const ntta_t& state, const search_metadata_t& metadata) -> stored_t {
+        if(compact.mode() != storage_mode_t::full) {
+            compact.insert(std::hash<ntta_t>{}(state));
+            return {};
+        }
+        if(!compressed)
+            return {P.add(parent, state, metadata), {}};
+        auto [root, inserted] = compressed->insert(state);
+        if(inserted)
+            compressed_parents.push_back(metadata.compressed_parent); // roots are handed out densely
+        return {{}, root};
+    }
+
+    void forward_reachability_searcher::add_waiting(const std::optional<solution_t>& parent, const ntta_t& state, const search_metadata_t& metadata, uint8_t pending) {
+        auto encoded = codec->encode_delta(state);
+        auto it = W.find(encoded);
+        if(it == W.end()) {
+            W.add({}, encoded, {parent, metadata, pending});
+            return;
+        }
+        // the state may be both a tick and a tock successor, then both are still to be done
+        it->second.metadata.pending |= pending;
+    }
+
+    auto forward_reachability_searcher::pop_waiting() -> std::pair<with_parent_t<ntta_t, search_metadata_t>, uint8_t> {
+        auto s = W.pop(strategy);
+        return {{s.metadata.parent, codec->decode_delta(s.data), s.metadata.search}, s.metadata.pending};
+    }
+
+    auto forward_reachability_searcher::materialize(const std::optional<solution_t>& parent, const ntta_t& state, const search_metadata_t& metadata) -> solution_t {
+        if(!compressed || !metadata.compressed_parent.has_value())
+            return P.add(parent, state, metadata);
+        // the compressed ancestors of a state reach all the way back to s0, so the P parent is not needed
+        std::vector<uint32_t> roots{};
+        for(auto r = metadata.compressed_parent; r.has_value(); r = compressed_parents.at(r.value()))
+            roots.push_back(r.value());
+        std::optional<solution_t> ancestor{};
+        for(auto it = roots.rbegin(); it != roots.rend(); it++)
+            ancestor = P.add(ancestor, compressed->decode(*it), {});
+        return P.add(ancestor, state, metadata);
+    }
+
+    auto forward_reachability_searcher::is_passed(const ntta_t& state) const -> bool {
+        auto hash = std::hash<ntta_t>{}(state);
+        return P.contains(hash, state) || compact.contains(hash) || (compressed && compressed->find(state).has_value());
+    }
+
+    auto forward_reachability_searcher::enforce_limits(bool can_degrade) -> bool {
+        if(limits.state_limit.has_value()) {
+            auto limit = limits.state_limit.value();
+            if(can_degrade && compact.mode() == storage_mode_t::full && P.size() + W.size() >= limit)
+                degrade(storage_mode_t::hash_compaction, 0);
+            else if(W.size() >= limit || (!can_degrade && P.size() >= limit))
+                return stop("state limit reached");
+        }
+        // reading the resident memory is a system call, so it is only checked every so often
+        if(limits.memory_limit.has_value() && ++limit_checks % 256 == 0) {
+            auto rss = memory::resident_bytes();
+            if(!rss.has_value())
+                return true;
+            auto limit = limits.memory_limit.value();
+            if(rss.value() >= limit)
+                return stop("memory limit reached");
+            if(!can_degrade)
+                return true;
+            if(compact.mode() == storage_mode_t::full && rss.value() >= limit / 4 * 3)
+                degrade(storage_mode_t::hash_compaction, 0);
+            else if(compact.mode() == storage_mode_t::hash_compaction && rss.value() >= limit / 10 * 9)
+                degrade(storage_mode_t::bitstate, (limit - rss.value()) / 2 * 8); // half of what is left, in bits
+        }
+        return true;
+    }
+
+    void forward_reachability_searcher::degrade(storage_mode_t mode, size_t bits) {
+        spdlog::warn("switching passed list storage to {0} (len(P)={1}, len(W)={2}), states may be missed and new traces skip states",
+                     mode == storage_mode_t::bitstate ? "bitstate" : "hash compaction", P.size(), W.size());
+        if(mode == storage_mode_t::bitstate)
+            compact.switch_to_bitstate(bits);
+        else
+            compact.switch_to_hash_compaction();
+    }
+
+    auto forward_reachability_searcher::stop(const std::string& reason) -> bool {
+        spdlog::warn("stopping search: {0}", reason);
+        statistics.stopped = true;
+        return false;
+    }
+
+    auto forward_reachability_searcher::search_layered(const std::vector<solution_t>& initial_layer) -> solutions_t {
+        // states are checked and added to P when they are generated, so the first state satisfying a query
+        // is in the shallowest layer that has one. Layers hold iterators into P, so W is not used
+        std::vector<solution_t> layer{initial_layer}, next{};
+        ntta_t::undo_t tick_undo{}, tock_undo{};
+        for(uint32_t depth = 1; !layer.empty(); depth++) {
+            next.clear();
+            for(auto& s_it : layer) {
+                if(is_interrupted()) {
+                    spdlog::warn("search interrupted at depth {0} (len(P)={1}), checkpoints are not supported with --shortest-trace", depth, P.size());
+                    statistics.stopped = true;
+                    return get_results();
                 }
-                /// Add tock-space states to W
-                spdlog::trace("{0} tock values available", sn_tocks.size());
-                auto sn_it = P.add(s_it, sn);
-                if(check_satisfactions(sn_it))
+                // layers point into P, so the storage can not be degraded here
+                if(!enforce_limits(false))
                     return get_results();
-                for(auto& so : sn_tocks) {
-                    auto sp = sn + so;
-                    if(!P.contains(sp))
-                        W.add_if_not_contains(sn_it, sp);
+                statistics.explored++;
+                statistics.max_depth = depth - 1;
+                // successors are applied to s in place and only copied into P when they are new
+                memory::scratch_scope scratch{scratch_arena};
+                auto s = s_it->second.data;
+                for(auto& si : s.tick()) {
+                    s.apply(si, tick_undo);
+                    canonicalize(s, tick_undo);
+                    if(P.contains(s)) {
+                        s.revert(tick_undo);
+                        continue;
+                    }
+                    auto sn_it = P.add(s_it, s, {state_delta_t::from(si), depth});
+                    if(check_satisfactions(sn_it))
+                        return get_results();
+                    auto sn_tocks = s.tock();
+                    if(sn_tocks.empty())
+                        next.push_back(sn_it);
+                    for(auto& so : sn_tocks) {
+                        s.apply(so, tock_undo);
+                        canonicalize(s, tock_undo);
+                        if(!P.contains(s)) {
+                            auto sp_it = P.add(sn_it, s, {state_delta_t::from(so, *s.interner), depth});
+                            if(check_satisfactions(sp_it))
+                                return get_results();
+                            next.push_back(sp_it);
+                        }
+                        s.revert(tock_undo);
+                    }
+                    s.revert(tick_undo);
                 }
             }
+            spdlog::debug("layer {0} has {1} new states (len(P)={2})", depth, next.size(), P.size());
+            std::swap(layer, next);
         }
-        /// Searched through all of the reachable state-space from s0
         spdlog::debug("end of reachable state-space");
         return get_results();
     }
 
-    auto forward_reachability_searcher::empty_solution_set(const std::vector<compiled_query_t>& qs) -> solutions_t {
+    auto forward_reachability_searcher::should_stop() -> bool {
+        if(is_interrupted()) {
+            spdlog::warn("search interrupted (len(P)={0}, len(W)={1})", P.size(), W.size());
+            statistics.stopped = true;
+            if(checkpoint.has_value())
+                save_checkpoint();
+            return true;
+        }
+        if(!checkpoint.has_value() || checkpoint->interval.count() <= 0)
+            return false;
+        auto now = std::chrono::steady_clock::now();
+        if(now - last_checkpoint >= checkpoint->interval) {
+            save_checkpoint();
+            last_checkpoint = now;
+        }
+        return false;
+    }
+
+    auto forward_reachability_searcher::get_query_strings() const -> std::vector<std::string> {
+        std::vector<std::string> result{};
+        for(auto& solution : solutions) {
+            std::stringstream ss{}; ss << solution.query;
+            result.push_back(ss.str());
+        }
+        return result;
+    }
+
+    void forward_reachability_searcher::save_checkpoint() {
+        checkpoint_writer writer{*codec, get_query_strings()};
+        std::unordered_map<const void*, uint64_t> index{};
+        for(auto it = P.begin(); it != P.end(); it++)
+            index.emplace(&(*it), index.size() + 1);
+        auto parent_index = [&index](const std::optional<solution_t>& parent) -> uint64_t {
+            return parent.has_value() ? index.at(&(*parent.value())) : 0;
+        };
+        writer.begin_section(P.size());
+        for(auto& e : P)
+            writer.add(parent_index(e.second.parent), e.second.metadata.depth, e.second.data);
+        writer.begin_section(W.size());
+        for(auto& e : W)
+            writer.add(parent_index(e.second.metadata.parent), e.second.metadata.search.depth, codec->decode_delta(e.second.data), e.second.metadata.pending);
+        for(auto& solution : solutions)
+            writer.add_solution(parent_index(solution.solution));
+        // states that were only stored as hashes or bits after the passed list degraded
+        writer.add_passed_set(compact.snapshot());
+        writer.save(checkpoint->path);
+    }
+
+    void forward_reachability_searcher::restore_checkpoint() {
+        checkpoint_reader reader{*codec, resume_path.value()};
+        if(reader.get_queries() != get_query_strings())
+            throw std::runtime_error(resume_path.value() + ": checkpoint was created for different queries");
+        // parents may be stored after their children, so links are restored once all of P is in place
+        std::vector<solution_t> passed{};
+        std::vector<uint64_t> parents{};
+        auto passed_count = reader.begin_section();
+        passed.reserve(passed_count);
+        parents.reserve(passed_count);
+        for(size_t i = 0; i < passed_count; i++) {
+            auto entry = reader.next_entry();
+            passed.push_back(P.add(std::optional<solution_t>{}, entry.state, {{}, entry.depth}));
+            parents.push_back(entry.parent);
+        }
+        auto parent_of = [&passed](uint64_t index) -> std::optional<solution_t> {
+            if(index == 0)
+                return {};
+            if(index > passed.size())
+                throw std::out_of_range("checkpoint refers to a state that does not exist");
+            return passed[index - 1];
+        };
+        for(size_t i = 0; i < passed_count; i++)
+            passed[i]->second.parent = parent_of(parents[i]);
+        auto waiting_count = reader.begin_section();
+        for(size_t i = 0; i < waiting_count; i++) {
+            auto entry = reader.next_entry();
+            add_waiting(parent_of(entry.parent), entry.state, {{}, entry.depth}, entry.pending);
+        }
+        for(auto& solution : solutions) {
+            auto index = reader.next_solution();
+            if(index != 0)
+                solution.solution = parent_of(index);
+        }
+        compact.restore(reader.next_passed_set());
+        if(compact.mode() != storage_mode_t::full)
+            spdlog::info("resuming with the degraded passed list storage ({0} states)", compact.size());
+        spdlog::info("resumed from checkpoint '{0}' (len(P)={1}, len(W)={2})", resume_path.value(), P.size(), W.size());
+    }
+
+    auto forward_reachability_searcher::empty_solution_set(const std::vector<compiled_query_t>& qs, const ntta_t& s0) -> solutions_t {
         solutions_t s{};
         for(auto& q : qs)
-            s.push_back({q});
+            s.emplace_back(q, compiled_predicate_t{q, s0});
         return s;
     }
 
     auto forward_reachability_searcher::check_satisfactions(const solution_t& s) -> bool {
-        // TODO: With AG queries, they are always "true" until you find a counter-example, then they are "false", but with a solution
-        //       right now, we are doing the opposite (https://github.com/sillydan1/aaltitoad/issues/41)
+        return check_satisfactions(s->second.data, s->second.metadata, [&s]{ return s; });
+    }
+
+    auto forward_reachability_searcher::check_satisfactions(const ntta_t& state, const search_metadata_t& metadata, const std::function<solution_t()>& store_solution) -> bool {
+        // safety predicates are negated, so a "solution" to an A G query is a counterexample
+        auto& delta = metadata.delta;
+        std::optional<solution_t> stored{};
         for(auto& solution : solutions) {
             if(solution.solution.has_value()) continue;
-            if(is_satisfied(solution.query, s->second.data))
-                solution.solution = s;
+            if(delta.has_value() && !solution.predicate.is_affected_by(delta.value())) {
+                skipped_checks++;
+                continue;
+            }
+            if(!solution.predicate.evaluate(state))
+                continue;
+            if(!stored.has_value())
+                stored = store_solution();
+            solution.solution = stored;
+            if(solution.kind == query_kind_t::safety)
+                spdlog::debug("found counterexample to safety query");
         }
         return std::all_of(solutions.begin(), solutions.end(), [](const query_solution_t& sol){ return sol.solution.has_value(); });
     }
@@ -101,9 +463,39 @@ namespace aaltitoad {
     }
 
     auto forward_reachability_searcher::get_results() -> solutions_t {
+        statistics.waiting = W.size();
+        statistics.storage = compact.mode();
+        statistics.stored_allocations = state_arena.get_statistics().allocations;
+        statistics.scratch_allocations = scratch_arena.get_statistics().allocations;
         spdlog::info("[{0}/{1}] queries with solutions (len(P)={2})", count_solutions(), solutions.size(), P.size());
+        spdlog::info("{0} states explored, {1} states waiting, depth {2} reached", statistics.explored, statistics.waiting, statistics.max_depth);
+        spdlog::debug("{0} query checks skipped due to unaffected query support", skipped_checks);
+        if(statistics.explored > 0)
+            spdlog::debug("{0:.1f} stored and {1:.1f} scratch arena allocations per explored state",
+                          static_cast<double>(statistics.stored_allocations) / static_cast<double>(statistics.explored),
+                          static_cast<double>(statistics.scratch_allocations) / static_cast<double>(statistics.explored));
+        if(compressed)
+            spdlog::info("{0} compressed states in {1} bytes", compressed->size(), compressed->memory_bytes());
+        if(statistics.stopped || statistics.storage != storage_mode_t::full) {
+            for(auto& solution : solutions) {
+                if(solution.solution.has_value())
+                    continue;
+                std::stringstream ss{}; ss << solution.query;
+                spdlog::warn("query '{0}' is undecided, the search did not cover the full state-space", ss.str());
+            }
+        }
         return solutions;
     }
+
+    auto forward_reachability_searcher::get_statistics() const -> const search_statistics_t& {
+        return statistics;
+    }
+
+    void forward_reachability_searcher::set_limits(const search_limits_t& l) {
+        limits = l;
+        if(limits.memory_limit.has_value() && !memory::resident_bytes().has_value())
+            spdlog::warn("resident memory can not be measured on this platform, the memory limit is ignored");
+    }
 }
 
 auto operator<<(std::ostream& o, const aaltitoad::forward_reachability_searcher::solution_t& s) -> std::ostream& { // NOLINT(misc-no-recursion)
@@ -18,35 +18,132 @@
 #ifndef AALTITOAD_FORWARD_REACHABILITY_H
 #define AALTITOAD_FORWARD_REACHABILITY_H
 #include "verification/ctl/ctl_sat.h"
+#include "verification/ctl/compiled_predicate.h"
 #include "ntta/tta.h"
 #include "traceable_multimap.h"
+#include "search_metadata.h"
+#include "dead_variable_reduction.h"
+#include "search_limits.h"
+#include "packed_state_store.h"
+#include "tree_compression.h"
+#include "state_codec.h"
+#include "util/arena.h"
 #include <ctl_syntax_tree.h>
 #include <nlohmann/json.hpp>
+#include <chrono>
+#include <functional>
 #include <vector>
 #include <utility>
 
 namespace aaltitoad {
     class forward_reachability_searcher {
     public:
-        using solution_t = traceable_multimap<ntta_t>::iterator_t;
+        using state_map_t = traceable_multimap<ntta_t, search_metadata_t>;
+        using solution_t = state_map_t::iterator_t;
         using compiled_query_t = ctl::syntax_tree_t;
         struct query_solution_t {
             compiled_query_t query;
-            std::optional<solution_t> solution;
-            query_solution_t(compiled_query_t query) : query{std::move(query)}, solution{} {}
+            compiled_predicate_t predicate;
+            query_kind_t kind;
+            std::optional<solution_t> solution; // witness for existential queries, counterexample for universal queries
+            query_solution_t(compiled_query_t query) : query{std::move(query)}, predicate{}, kind{get_query_kind(this->query)}, solution{} {}
+            query_solution_t(compiled_query_t query, compiled_predicate_t predicate) : query{std::move(query)}, predicate{std::move(predicate)}, kind{get_query_kind(this->query)}, solution{} {}
+            auto holds() const -> bool { return is_negated_query(kind) ? !solution.has_value() : solution.has_value(); }
         };
         using solutions_t = std::vector<query_solution_t>;
+        struct search_statistics_t {
+            size_t explored{};    // states popped from the waiting list
+            size_t waiting{};     // states left in the waiting list
+            uint32_t max_depth{}; // deepest explored tick depth
+            storage_mode_t storage{storage_mode_t::full};
+            bool stopped{};       // a limit or an interrupt ended the search before the state-space was exhausted
+            size_t stored_allocations{};  // P nodes, see set_huge_pages
+            size_t scratch_allocations{}; // temporaries of tick and tock, freed after every expansion
+        };
         explicit forward_reachability_searcher(const pick_strategy& strategy = pick_strategy::first);
         auto is_reachable(const ntta_t& s0, const compiled_query_t& q) -> solutions_t;
         auto is_reachable(const ntta_t& s0, const std::vector<compiled_query_t>& q) -> solutions_t;
+        // reset dead symbols to their initial values before states are compared, see dead_variable_reducer
+        void set_dead_variable_reduction(bool enabled);
+        // search layer by layer, such that every solution is found with the fewest possible ticks
+        void set_shortest_trace(bool enabled);
+        // write a checkpoint when interrupted and every interval (0 disables periodic checkpoints)
+        void set_checkpoint(const std::string& path, std::chrono::minutes interval);
+        // continue the search from a checkpoint written for the same model and queries
+        void set_resume(const std::string& path);
+        // degrade the passed list storage, and eventually stop, when a limit is reached. See storage_mode_t
+        void set_limits(const search_limits_t& limits);
+        auto get_statistics() const -> const search_statistics_t&;
+        // back the arena that P is allocated from with transparent huge pages, if the platform supports it
+        void set_huge_pages(bool enabled);
+        // store passed states in a tree_compressed_store instead of P. P then only holds the traces of solutions,
+        // which are decoded from the tree when a solution is found. Not supported with --shortest-trace
+        void set_tree_compression(bool enabled);
+        // like set_tree_compression, but the passed states are bit-packed, see packed_state_store. Takes precedence
+        // over tree compression
+        void set_packed_states(bool enabled);
 
     private:
-        traceable_multimap<ntta_t> W{}, P{};
+        // waiting states are delta encoded against s0 and decoded when popped, see state_codec::encode_delta
+        struct waiting_metadata_t {
+            std::optional<solution_t> parent{}; // the parent in P, W's own parent links are not used
+            search_metadata_t search{};
+            uint8_t pending{}; // see pending_work_t
+        };
+        using waiting_list_t = traceable_multimap<encoded_state_t, waiting_metadata_t>;
+        // P only grows during a search, so its nodes are bump allocated and released all at once
+        memory::arena_resource state_arena{};
+        memory::arena_resource scratch_arena{};
+        waiting_list_t W{};
+        state_map_t P{&state_arena};
+        std::shared_ptr<const state_codec> codec{};
         solutions_t solutions{};
         pick_strategy strategy{};
+        size_t skipped_checks{};
+        bool reduce_dead_variables{false};
+        bool shortest_trace{false};
+        struct checkpoint_config_t {
+            std::string path;
+            std::chrono::minutes interval;
+        };
+        std::optional<checkpoint_config_t> checkpoint{};
+        std::optional<std::string> resume_path{};
+        std::chrono::steady_clock::time_point last_checkpoint{};
+        search_limits_t limits{};
+        compact_passed_set compact{};
+        search_statistics_t statistics{};
+        size_t limit_checks{};
+        std::optional<dead_variable_reducer> reducer{};
+        bool tree_compression{false};
+        bool packed_states{false};
+        std::unique_ptr<compressed_state_store> compressed{};
+        std::vector<std::optional<uint32_t>> compressed_parents{}; // indexed by root
+        struct stored_t {
+            std::optional<solution_t> it{};   // the state in P
+            std::optional<uint32_t> root{};   // the state in the compressed store
+        };
 
-        static auto empty_solution_set(const std::vector<compiled_query_t>& q) -> solutions_t;
+        static auto empty_solution_set(const std::vector<compiled_query_t>& q, const ntta_t& s0) -> solutions_t;
         auto check_satisfactions(const solution_t& s) -> bool;
+        // store_solution is called at most once, when the state solves a query
+        auto check_satisfactions(const ntta_t& state, const search_metadata_t& metadata, const std::function<solution_t()>& store_solution) -> bool;
+        auto store(const std::optional<solution_t>& parent, const ntta_t& state, const search_metadata_t& metadata) -> stored_t;
+        // add the state, and its compressed ancestors, to P
+        auto materialize(const std::optional<solution_t>& parent, const ntta_t& state, const search_metadata_t& metadata) -> solution_t;
+        auto is_passed(const ntta_t& state) const -> bool;
+        void add_waiting(const std::optional<solution_t>& parent, const ntta_t& state, const search_metadata_t& metadata, uint8_t pending);
+        auto pop_waiting() -> std::pair<with_parent_t<ntta_t, search_metadata_t>, uint8_t>;
+        auto enforce_limits(bool can_degrade) -> bool;
+        void degrade(storage_mode_t mode, size_t bits);
+        auto stop(const std::string& reason) -> bool;
+        auto search_waiting_list() -> solutions_t;
+        auto search_layered(const std::vector<solution_t>& initial_layer) -> solutions_t;
+        auto should_stop() -> bool;
+        void save_checkpoint();
+        void restore_checkpoint();
+        auto get_query_strings() const -> std::vector<std::string>;
+        void canonicalize(ntta_t& s) const;
+        void canonicalize(ntta_t& s, ntta_t::undo_t& undo) const;
         auto count_solutions() -> size_t;
         auto get_results() -> solutions_t;
     };
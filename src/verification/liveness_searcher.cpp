@@ -0,0 +1,125 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "liveness_searcher.h"
+#include "checkpoint.h"
+#include <spdlog/spdlog.h>
+
+namespace aaltitoad {
+    auto liveness_searcher::search(const ntta_t& s0, const std::vector<ctl::syntax_tree_t>& q) -> solutions_t {
+        solutions_t solutions{};
+        maps.clear(); interrupted = false;
+        for(auto& query : q) {
+            solutions.emplace_back(query, compiled_predicate_t{query, s0});
+            if(!is_liveness_query(solutions.back().kind))
+                throw std::logic_error("liveness_searcher only supports E G and A F queries");
+            if(!interrupted)
+                find_lasso(s0, solutions.back(), maps.emplace_back());
+        }
+        if(interrupted)
+            spdlog::warn("liveness search interrupted, queries without a solution are undecided");
+        size_t stored = 0;
+        for(auto& P : maps)
+            stored += P.size();
+        spdlog::info("[{0}/{1}] liveness queries hold (len(P)={2})",
+                     std::count_if(solutions.begin(), solutions.end(), [](const query_solution_t& s){ return s.holds(); }),
+                     solutions.size(), stored);
+        return solutions;
+    }
+
+    void liveness_searcher::find_lasso(const ntta_t& s0, query_solution_t& query, forward_reachability_searcher::state_map_t& P) {
+        std::vector<ntta_t> roots{s0};
+        for(auto& l : s0.tock())
+            roots.push_back(s0 + l);
+        std::unordered_set<const void*> visited{};
+        for(auto& root : roots) {
+            if(!query.predicate.evaluate(root))
+                continue;
+            on_stack.clear(); stack.clear();
+            if(push(P.add(root), query.predicate)) {
+                query.solution = stack.back().state;
+                spdlog::debug("found deadlocking path");
+                return;
+            }
+            visited.insert(&(*stack.back().state));
+            while(!stack.empty()) {
+                if(is_interrupted()) {
+                    interrupted = true;
+                    return;
+                }
+                auto& frame = stack.back();
+                if(frame.next >= frame.successors.size()) {
+                    on_stack.erase(&(*frame.state));
+                    stack.pop_back();
+                    continue;
+                }
+                auto parent = frame.state;
+                auto& sn = frame.successors[frame.next++];
+                auto it = P.find(sn);
+                if(it != P.end() && visited.contains(&(*it))) {
+                    if(!on_stack.contains(&(*it)))
+                        continue;
+                    // close the lasso by repeating the state at the end of the trace
+                    query.solution = P.add(parent, sn, {{}, parent->second.metadata.depth + 1});
+                    spdlog::debug("found lasso of length {0}", stack.size());
+                    return;
+                }
+                auto sn_it = P.add(parent, sn, {{}, parent->second.metadata.depth + 1});
+                visited.insert(&(*sn_it));
+                if(push(sn_it, query.predicate)) {
+                    query.solution = sn_it;
+                    spdlog::debug("found deadlocking path");
+                    return;
+                }
+            }
+        }
+    }
+
+    auto liveness_searcher::is_complete() const -> bool {
+        return !interrupted;
+    }
+
+    auto liveness_searcher::push(const solution_t& state, const compiled_predicate_t& predicate) -> bool {
+        bool is_deadlock = false;
+        stack.push_back({state, successors(state->second.data, predicate, is_deadlock), 0});
+        on_stack.insert(&(*state));
+        return is_deadlock;
+    }
+
+    auto liveness_searcher::successors(ntta_t state, const compiled_predicate_t& predicate, bool& is_deadlock) -> std::vector<ntta_t> {
+        std::vector<ntta_t> result{};
+        auto changes = state.tick();
+        is_deadlock = changes.empty();
+        for(auto& si : changes) {
+            auto sn = state + si;
+            // the tick-space state is visited on the way to its tock-space states, so it must satisfy the predicate too
+            if(!predicate.evaluate(sn))
+                continue;
+            auto sn_tocks = sn.tock();
+            if(sn_tocks.empty()) {
+                result.push_back(sn);
+                continue;
+            }
+            for(auto& so : sn_tocks) {
+                auto sp = sn + so;
+                if(predicate.evaluate(sp))
+                    result.push_back(sp);
+            }
+        }
+        return result;
+    }
+}
@@ -0,0 +1,56 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_LIVENESS_SEARCHER_H
+#define AALTITOAD_LIVENESS_SEARCHER_H
+#include "forward_reachability.h"
+#include <list>
+#include <unordered_set>
+
+namespace aaltitoad {
+    // On-the-fly checker for E G p and A F p (= !E G !p) queries.
+    // Every state of the p-restricted state graph is accepting, so a plain depth-first search suffices:
+    // a back-edge to the search stack closes a lasso, and a deadlocking p-state ends a maximal path.
+    class liveness_searcher {
+    public:
+        using solution_t = forward_reachability_searcher::solution_t;
+        using query_solution_t = forward_reachability_searcher::query_solution_t;
+        using solutions_t = forward_reachability_searcher::solutions_t;
+        auto search(const ntta_t& s0, const std::vector<ctl::syntax_tree_t>& q) -> solutions_t;
+        // false if the last search was interrupted, so queries without a solution are undecided
+        auto is_complete() const -> bool;
+
+    private:
+        struct frame_t {
+            solution_t state;
+            std::vector<ntta_t> successors;
+            size_t next;
+        };
+        // one map per query, such that entries added by earlier queries are never mistaken for visited states.
+        // A list, because the solutions point into the maps
+        std::list<forward_reachability_searcher::state_map_t> maps{};
+        std::unordered_set<const void*> on_stack{};
+        std::vector<frame_t> stack{};
+        bool interrupted{};
+
+        void find_lasso(const ntta_t& s0, query_solution_t& query, forward_reachability_searcher::state_map_t& P);
+        auto push(const solution_t& state, const compiled_predicate_t& predicate) -> bool;
+        static auto successors(ntta_t state, const compiled_predicate_t& predicate, bool& is_deadlock) -> std::vector<ntta_t>;
+    };
+}
+
+#endif //AALTITOAD_LIVENESS_SEARCHER_H
@@ -0,0 +1,240 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "packed_state_store.h"
+#include "util/hash_kernel.h"
+#include <algorithm>
+#include <bit>
+#include <spdlog/spdlog.h>
+
+namespace aaltitoad {
+    namespace {
+        auto mask(uint32_t width) -> uint64_t {
+            return width >= 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+        }
+
+        auto payload_width(value_tag_t tag) -> uint32_t {
+            switch(tag) {
+                case value_tag_t::_bool: return 1;
+                case value_tag_t::_clock: return 64;
+                default: return 32; // zigzag encoded ints, float bits and interned string ids
+            }
+        }
+    }
+
+    packed_state_store::packed_state_store(const ntta_t& s0) : packed_state_store{s0, infer_domains(s0)} {}
+
+    packed_state_store::packed_state_store(const ntta_t& s0, domain_map_t domains) : prototype{s0}, state_layout{prototype}, domains{std::move(domains)} {
+        layout = build_layout();
+        slots.assign(16, 0);
+        spdlog::debug("packing states into {0} bits ({1} words), {2} hash kernel", bits_per_state(), layout.stride, hashing::to_string(hashing::active_kernel()));
+    }
+
+    auto packed_state_store::build_layout() const -> layout_t {
+        layout_t result{};
+        uint32_t word = 0, shift = 0;
+        auto place = [&](field_t field) {
+            if(shift + field.width > 64) {
+                word++;
+                shift = 0;
+            }
+            field.word = word;
+            field.shift = shift;
+            shift += field.width;
+            result.fields.push_back(field);
+        };
+        for(auto& component : state_layout.components())
+            place({field_kind_t::location, {}, 0, 0, static_cast<uint32_t>(std::bit_width(component.nodes.size() - 1))});
+        for(auto* table : {&prototype.symbols, &prototype.external_symbols}) {
+            for(auto& symbol : *table) {
+                auto domain = domains.find(symbol.first);
+                auto tag = to_tagged(symbol.second, [](const std::string&){ return uint64_t{0}; }).tag;
+                if(retagged.contains(result.fields.size()))
+                    place({field_kind_t::tagged, {}, 0, 0, 64});
+                else if(tag == value_tag_t::_int && table == &prototype.symbols && domain != domains.end() && !widened.contains(result.fields.size()))
+                    place({field_kind_t::bounded_int, tag, 0, 0, domain->second.width(), domain->second.min});
+                else
+                    place({field_kind_t::value, tag, 0, 0, payload_width(tag)});
+            }
+        }
+        result.stride = word + 1;
+        return result;
+    }
+
+    auto packed_state_store::field_bits(const field_t& field, const expr::symbol_value_t& value, string_pool_t* pool) const -> std::optional<uint64_t> {
+        switch(field.kind) {
+            case field_kind_t::bounded_int: {
+                auto& v = static_cast<const expr::underlying_symbol_value_t&>(value);
+                if(!std::holds_alternative<int>(v))
+                    return {};
+                auto offset = static_cast<int64_t>(std::get<int>(v)) - field.min;
+                if(offset < 0 || (static_cast<uint64_t>(offset) & ~mask(field.width)) != 0)
+                    return {};
+                return static_cast<uint64_t>(offset);
+            }
+            case field_kind_t::value: {
+                auto tagged = to_tagged(value, pool, strings);
+                if(!tagged.has_value() || tagged->tag != field.tag)
+                    return {};
+                return tagged->payload;
+            }
+            case field_kind_t::tagged: {
+                auto tagged = to_tagged(value, pool, strings);
+                if(!tagged.has_value())
+                    return {};
+                return to_word(tagged.value());
+            }
+            default: throw std::logic_error("not a symbol field");
+        }
+    }
+
+    void packed_state_store::set_value(const field_t& field, uint64_t bits, expr::symbol_value_t& value) const {
+        switch(field.kind) {
+            case field_kind_t::bounded_int: value = static_cast<int>(field.min + static_cast<int64_t>(bits)); break;
+            case field_kind_t::value: from_tagged({field.tag, bits}, [this](uint64_t id){ return strings.at(id); }, value); break;
+            case field_kind_t::tagged: from_tagged(from_word(bits), [this](uint64_t id){ return strings.at(id); }, value); break;
+            default: throw std::logic_error("not a symbol field");
+        }
+    }
+
+    auto packed_state_store::pack(const layout_t& l, const ntta_t& state, uint64_t* out, string_pool_t* pool) const -> std::optional<size_t> {
+        std::fill(out, out + l.stride, 0);
+        size_t i = 0;
+        for(; i < state_layout.components().size(); i++)
+            out[l.fields[i].word] |= static_cast<uint64_t>(state_layout.location_id(state, i)) << l.fields[i].shift;
+        for(auto* table : {&state.symbols, &state.external_symbols}) {
+            for(auto& symbol : *table) {
+                auto& field = l.fields[i];
+                auto bits = field_bits(field, symbol.second, pool);
+                if(!bits.has_value())
+                    return i;
+                if(field.width > 0)
+                    out[field.word] |= bits.value() << field.shift;
+                i++;
+            }
+        }
+        return {};
+    }
+
+    auto packed_state_store::unpack(const layout_t& l, const uint64_t* in) const -> ntta_t {
+        auto state = prototype;
+        auto read = [in](const field_t& field) { return field.width == 0 ? 0 : (in[field.word] >> field.shift) & mask(field.width); };
+        size_t i = 0;
+        for(; i < state_layout.components().size(); i++)
+            state_layout.set_location(state, i, read(l.fields[i]));
+        for(auto* table : {&state.symbols, &state.external_symbols}) {
+            for(auto& symbol : *table) {
+                auto& field = l.fields[i++];
+                set_value(field, read(field), symbol.second);
+            }
+        }
+        return state;
+    }
+
+    void packed_state_store::widen(size_t field) {
+        // an out of domain integer gets its full width, a value that changed its type gets a tagged field
+        if(layout.fields[field].kind == field_kind_t::bounded_int)
+            widened.insert(field);
+        else
+            retagged.insert(field);
+        auto old = std::move(layout);
+        layout = build_layout();
+        spdlog::debug("a value did not fit its inferred domain, repacking {0} states into {1} bits", count, bits_per_state());
+        std::vector<uint64_t> repacked(count * layout.stride, 0);
+        for(size_t i = 0; i < count; i++)
+            pack(layout, unpack(old, words.data() + i * old.stride), repacked.data() + i * layout.stride, &strings);
+        words = std::move(repacked);
+        rehash(slots.size());
+    }
+
+    auto packed_state_store::hash(const uint64_t* packed) const -> uint64_t {
+        return hashing::hash_words(packed, layout.stride);
+    }
+
+    auto packed_state_store::probe(const uint64_t* packed) const -> std::pair<size_t, bool> {
+        auto m = slots.size() - 1;
+        auto i = hash(packed) & m;
+        for(; slots[i] != 0; i = (i + 1) & m)
+            if(hashing::equal_words(packed, words.data() + (slots[i] - 1) * layout.stride, layout.stride))
+                return {i, true};
+        return {i, false};
+    }
+
+    void packed_state_store::rehash(size_t slot_count) {
+        slots.assign(slot_count, 0);
+        auto m = slot_count - 1;
+        for(size_t index = 0; index < count; index++) {
+            auto i = hash(words.data() + index * layout.stride) & m;
+            while(slots[i] != 0)
+                i = (i + 1) & m;
+            slots[i] = static_cast<uint32_t>(index + 1);
+        }
+    }
+
+    auto packed_state_store::insert(const ntta_t& state) -> std::pair<index_t, bool> {
+        scratch.resize(layout.stride);
+        for(auto field = pack(layout, state, scratch.data(), &strings); field.has_value(); field = pack(layout, state, scratch.data(), &strings)) {
+            widen(field.value());
+            scratch.resize(layout.stride);
+        }
+        auto [slot, found] = probe(scratch.data());
+        if(found)
+            return {slots[slot] - 1, false};
+        if((count + 1) * 2 > slots.size()) {
+            rehash(slots.size() * 2);
+            slot = probe(scratch.data()).first;
+        }
+        words.insert(words.end(), scratch.begin(), scratch.end());
+        slots[slot] = static_cast<uint32_t>(++count);
+        return {static_cast<index_t>(count - 1), true};
+    }
+
+    auto packed_state_store::find(const ntta_t& state) const -> std::optional<index_t> {
+        scratch.resize(layout.stride);
+        if(pack(layout, state, scratch.data(), nullptr).has_value())
+            return {}; // values outside of the domains, and strings that were never interned, have never been stored
+        auto [slot, found] = probe(scratch.data());
+        if(!found)
+            return {};
+        return slots[slot] - 1;
+    }
+
+    auto packed_state_store::decode(index_t index) const -> ntta_t {
+        if(index >= count)
+            throw std::out_of_range("no such packed state");
+        return unpack(layout, words.data() + index * layout.stride);
+    }
+
+    auto packed_state_store::size() const -> size_t {
+        return count;
+    }
+
+    auto packed_state_store::memory_bytes() const -> size_t {
+        return words.capacity() * sizeof(uint64_t) + slots.capacity() * sizeof(uint32_t);
+    }
+
+    auto packed_state_store::words_per_state() const -> size_t {
+        return layout.stride;
+    }
+
+    auto packed_state_store::bits_per_state() const -> size_t {
+        size_t result = 0;
+        for(auto& field : layout.fields)
+            result += field.width;
+        return result;
+    }
+}
@@ -0,0 +1,88 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_PACKED_STATE_STORE_H
+#define AALTITOAD_PACKED_STATE_STORE_H
+#include "compressed_state_store.h"
+#include "domain_inference.h"
+#include "state_layout.h"
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace aaltitoad {
+    // Stores states as fixed-size vectors of 64 bit words. Every location and symbol gets a bit field that is as narrow
+    // as its domain allows: locations use the number of locations of their component, booleans one bit, and integers
+    // with an inferred domain (see infer_domains) their offset from the lower bound. Other values use their full width,
+    // strings are interned. Hashing and equality work on whole words.
+    // If a value does not fit its field, because the inferred domain missed a write, the field is widened and all
+    // stored states are repacked. A symbol that changes its type, e.g. from int to float, gets a tagged 64 bit field
+    class packed_state_store : public compressed_state_store {
+    public:
+        explicit packed_state_store(const ntta_t& s0);
+        packed_state_store(const ntta_t& s0, domain_map_t domains);
+        auto insert(const ntta_t& state) -> std::pair<index_t, bool> override;
+        auto find(const ntta_t& state) const -> std::optional<index_t> override;
+        auto decode(index_t index) const -> ntta_t override;
+        auto size() const -> size_t override;
+        auto memory_bytes() const -> size_t override;
+        auto words_per_state() const -> size_t;
+        auto bits_per_state() const -> size_t;
+
+    private:
+        enum class field_kind_t : uint8_t {
+            location, bounded_int,
+            value, // the payload of a tagged value with the type of the field, see to_tagged
+            tagged // a tagged value of any type, see to_word
+        };
+        struct field_t {
+            field_kind_t kind;
+            value_tag_t tag{};
+            uint32_t word{}, shift{}, width{};
+            int64_t min{}; // offset of bounded integers
+        };
+        struct layout_t {
+            std::vector<field_t> fields{}; // components, then symbols, then external symbols
+            size_t stride{};               // words per state
+        };
+        ntta_t prototype;
+        state_layout_t state_layout;
+        domain_map_t domains;
+        layout_t layout{};
+        std::set<size_t> widened{}; // fields that do not use their inferred domain
+        std::set<size_t> retagged{}; // fields whose symbol changed its type
+        std::vector<uint64_t> words{};
+        std::vector<uint32_t> slots{}; // index + 1, 0 is empty
+        size_t count{};
+        mutable std::vector<uint64_t> scratch{};
+        string_pool_t strings{};
+
+        auto build_layout() const -> layout_t;
+        // the index of the first field that the state does not fit. Strings are interned into pool, without a pool
+        // a string that is not interned does not fit
+        auto pack(const layout_t& l, const ntta_t& state, uint64_t* out, string_pool_t* pool) const -> std::optional<size_t>;
+        auto unpack(const layout_t& l, const uint64_t* in) const -> ntta_t;
+        auto field_bits(const field_t& field, const expr::symbol_value_t& value, string_pool_t* pool) const -> std::optional<uint64_t>;
+        void set_value(const field_t& field, uint64_t bits, expr::symbol_value_t& value) const;
+        void widen(size_t field);
+        void rehash(size_t slot_count);
+        auto hash(const uint64_t* packed) const -> uint64_t;
+        auto probe(const uint64_t* packed) const -> std::pair<size_t, bool>; // slot, and whether it holds the state
+    };
+}
+
+#endif //AALTITOAD_PACKED_STATE_STORE_H
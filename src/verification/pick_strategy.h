@@ -20,7 +20,7 @@
 
 namespace aaltitoad {
     enum class pick_strategy {
-        first, last, random
+        first, last, random, best_first
     };
 }
 
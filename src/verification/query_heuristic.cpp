@@ -0,0 +1,183 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "query_heuristic.h"
+#include "ctl_sat.h"
+#include <spdlog/spdlog.h>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace aaltitoad {
+    auto as_number(const expr::symbol_value_t& v) -> std::optional<double> {
+        return std::visit(ya::overload(
+                [](const int& x) -> std::optional<double> { return static_cast<double>(x); },
+                [](const float& x) -> std::optional<double> { return static_cast<double>(x); },
+                [](const bool& x) -> std::optional<double> { return x ? 1.0 : 0.0; },
+                [](const expr::clock_t& x) -> std::optional<double> { return static_cast<double>(x.time_units); },
+                [](auto&&) -> std::optional<double> { return {}; }
+        ), static_cast<const expr::underlying_symbol_value_t&>(v));
+    }
+
+    query_distance_heuristic::query_distance_heuristic(const std::vector<ctl::syntax_tree_t>& queries, const ntta_t& s0) {
+        for(auto& query : queries) {
+            // safety and liveness queries are not searched for a positive predicate, so the distance would be misleading
+            if(get_query_kind(query) != query_kind_t::reachability)
+                continue;
+            goal_t goal{};
+            collect(query, true, s0, goal);
+            if(!goal.locations.empty() || !goal.comparisons.empty())
+                goals.push_back(std::move(goal));
+        }
+        spdlog::debug("best-first heuristic guided by {0} queries", goals.size());
+    }
+
+    auto query_distance_heuristic::score(const ntta_t& state) const -> double {
+        if(goals.empty())
+            return 0;
+        auto result = std::numeric_limits<double>::max();
+        for(auto& goal : goals) {
+            double d = 0;
+            for(auto& l : goal.locations)
+                d += distance(l, state);
+            for(auto& c : goal.comparisons)
+                d += distance(c, state);
+            result = std::min(result, d);
+        }
+        return result;
+    }
+
+    void query_distance_heuristic::collect(const ctl::syntax_tree_t& tree, bool positive, const ntta_t& s0, goal_t& goal) { // NOLINT(misc-no-recursion)
+        std::visit(ya::overload(
+                [&](const expr::syntax_tree_t& v) { collect(v, positive, goal); },
+                [&](const ctl::location_t& v) {
+                    if(!positive)
+                        return;
+                    location_goal_t g{{}, 0};
+                    for(auto& component : s0.components) {
+                        if(!component.second.graph->nodes.contains(v.location_name))
+                            continue;
+                        g.candidates.emplace_back(component.first, distances_to(component.second, v.location_name));
+                        g.unreachable = std::max(g.unreachable, static_cast<uint32_t>(component.second.graph->nodes.size()));
+                    }
+                    if(!g.candidates.empty())
+                        goal.locations.push_back(std::move(g));
+                },
+                [&](const expr::operator_t& v) {
+                    auto p = v.operator_type == expr::operator_type_t::_not ? !positive : positive;
+                    for(auto& c : tree.children())
+                        collect(c, p, s0, goal);
+                },
+                [&](auto&&) {
+                    for(auto& c : tree.children())
+                        collect(c, positive, s0, goal);
+                }
+        ), static_cast<const ctl::underlying_syntax_node_t&>(tree.node));
+    }
+
+    void query_distance_heuristic::collect(const expr::syntax_tree_t& tree, bool positive, goal_t& goal) { // NOLINT(misc-no-recursion)
+        auto& node = static_cast<const expr::underlying_syntax_node_t&>(tree.node);
+        if(!std::holds_alternative<expr::operator_t>(node)) {
+            for(auto& c : tree.children())
+                collect(c, positive, goal);
+            return;
+        }
+        auto op = std::get<expr::operator_t>(node).operator_type;
+        switch(op) {
+            case expr::operator_type_t::_not:
+                for(auto& c : tree.children())
+                    collect(c, !positive, goal);
+                return;
+            case expr::operator_type_t::_lt:
+            case expr::operator_type_t::_le:
+            case expr::operator_type_t::_gt:
+            case expr::operator_type_t::_ge:
+            case expr::operator_type_t::_ee:
+            case expr::operator_type_t::_ne: {
+                if(!positive || tree.children().size() != 2)
+                    return;
+                auto& lhs = static_cast<const expr::underlying_syntax_node_t&>(tree.children()[0].node);
+                auto& rhs = static_cast<const expr::underlying_syntax_node_t&>(tree.children()[1].node);
+                // only '<symbol> <op> <literal>' is estimated, the simplifier puts literals on the right-hand side
+                if(!std::holds_alternative<expr::identifier_t>(lhs) || !std::holds_alternative<expr::symbol_value_t>(rhs))
+                    return;
+                auto value = as_number(std::get<expr::symbol_value_t>(rhs));
+                if(value.has_value())
+                    goal.comparisons.push_back({std::get<expr::identifier_t>(lhs).ident, op, value.value()});
+                return;
+            }
+            default:
+                for(auto& c : tree.children())
+                    collect(c, positive, goal);
+        }
+    }
+
+    auto query_distance_heuristic::distances_to(const tta_t& component, const std::string& location) -> distance_map_t {
+        distance_map_t result{};
+        std::queue<tta_t::graph_node_iterator_t> worklist{};
+        auto target = component.graph->nodes.find(location);
+        result[&(*target)] = 0;
+        worklist.push(target);
+        while(!worklist.empty()) {
+            auto n = worklist.front(); worklist.pop();
+            auto d = result.at(&(*n));
+            for(auto& e : n->second.ingoing_edges) {
+                auto& source = e->second.source;
+                if(result.contains(&(*source)))
+                    continue;
+                result[&(*source)] = d + 1;
+                worklist.push(source);
+            }
+        }
+        return result;
+    }
+
+    auto query_distance_heuristic::distance(const location_goal_t& goal, const ntta_t& state) -> double {
+        auto result = goal.unreachable;
+        for(auto& candidate : goal.candidates) {
+            auto component = state.components.find(candidate.first);
+            if(component == state.components.end())
+                continue;
+            auto d = candidate.second.find(&(*component->second.current_location));
+            if(d != candidate.second.end())
+                result = std::min(result, d->second);
+        }
+        return result;
+    }
+
+    auto query_distance_heuristic::distance(const comparison_goal_t& goal, const ntta_t& state) -> double {
+        auto it = state.symbols.find(goal.symbol);
+        if(it == state.symbols.end()) {
+            it = state.external_symbols.find(goal.symbol);
+            if(it == state.external_symbols.end())
+                return 0;
+        }
+        auto v = as_number(it->second);
+        if(!v.has_value())
+            return 0;
+        auto x = v.value();
+        switch(goal.op) {
+            case expr::operator_type_t::_lt: return std::max(0.0, x - goal.value + 1);
+            case expr::operator_type_t::_le: return std::max(0.0, x - goal.value);
+            case expr::operator_type_t::_gt: return std::max(0.0, goal.value - x + 1);
+            case expr::operator_type_t::_ge: return std::max(0.0, goal.value - x);
+            case expr::operator_type_t::_ee: return std::abs(x - goal.value);
+            case expr::operator_type_t::_ne: return x == goal.value ? 1 : 0;
+            default: return 0;
+        }
+    }
+}
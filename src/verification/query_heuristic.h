@@ -0,0 +1,59 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_QUERY_HEURISTIC_H
+#define AALTITOAD_QUERY_HEURISTIC_H
+#include <ctl_syntax_tree.h>
+#include <ntta/tta.h>
+#include <unordered_map>
+#include <vector>
+
+namespace aaltitoad {
+    // Estimates how far a state is from satisfying any of a set of reachability queries.
+    // Positive location atoms contribute the static shortest-path distance in the component's location graph,
+    // positive comparison atoms contribute the numeric distance between the symbol value and the literal
+    class query_distance_heuristic {
+    public:
+        query_distance_heuristic(const std::vector<ctl::syntax_tree_t>& queries, const ntta_t& s0);
+        auto score(const ntta_t& state) const -> double;
+
+    private:
+        using distance_map_t = std::unordered_map<const void*, uint32_t>;
+        struct location_goal_t {
+            std::vector<std::pair<std::string, distance_map_t>> candidates;
+            uint32_t unreachable;
+        };
+        struct comparison_goal_t {
+            std::string symbol;
+            expr::operator_type_t op;
+            double value;
+        };
+        struct goal_t {
+            std::vector<location_goal_t> locations{};
+            std::vector<comparison_goal_t> comparisons{};
+        };
+        std::vector<goal_t> goals{};
+
+        void collect(const ctl::syntax_tree_t& tree, bool positive, const ntta_t& s0, goal_t& goal);
+        void collect(const expr::syntax_tree_t& tree, bool positive, goal_t& goal);
+        static auto distances_to(const tta_t& component, const std::string& location) -> distance_map_t;
+        static auto distance(const location_goal_t& goal, const ntta_t& state) -> double;
+        static auto distance(const comparison_goal_t& goal, const ntta_t& state) -> double;
+    };
+}
+
+#endif //AALTITOAD_QUERY_HEURISTIC_H
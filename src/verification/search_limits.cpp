@@ -0,0 +1,112 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "search_limits.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace aaltitoad {
+    auto compact_passed_set::mode() const -> storage_mode_t {
+        return storage;
+    }
+
+    auto compact_passed_set::bit_indices(size_t hash) const -> std::pair<size_t, size_t> {
+        // the second index is derived from a remixed hash, such that both bits are roughly independent
+        auto n = bits.size() * 64;
+        auto h2 = hash * 0x9e3779b97f4a7c15ull;
+        h2 ^= h2 >> 29;
+        return {hash % n, h2 % n};
+    }
+
+    auto compact_passed_set::contains(size_t hash) const -> bool {
+        switch(storage) {
+            case storage_mode_t::full: return false;
+            case storage_mode_t::hash_compaction: return hashes.contains(hash);
+            case storage_mode_t::bitstate: {
+                auto [a, b] = bit_indices(hash);
+                return (bits[a / 64] & (uint64_t{1} << (a % 64))) != 0
+                    && (bits[b / 64] & (uint64_t{1} << (b % 64))) != 0;
+            }
+        }
+        return false;
+    }
+
+    void compact_passed_set::insert(size_t hash) {
+        switch(storage) {
+            case storage_mode_t::full: throw std::logic_error("compact_passed_set is not in a degraded storage mode");
+            case storage_mode_t::hash_compaction:
+                hashes.insert(hash);
+                hashes.reclaim(); // the searcher is the only thread using the set
+                break;
+            case storage_mode_t::bitstate: {
+                auto [a, b] = bit_indices(hash);
+                bits[a / 64] |= uint64_t{1} << (a % 64);
+                bits[b / 64] |= uint64_t{1} << (b % 64);
+                break;
+            }
+        }
+        inserted++;
+    }
+
+    auto compact_passed_set::size() const -> size_t {
+        return inserted;
+    }
+
+    void compact_passed_set::switch_to_hash_compaction() {
+        storage = storage_mode_t::hash_compaction;
+    }
+
+    void compact_passed_set::switch_to_bitstate(size_t bit_count) {
+        bits.assign(std::max<size_t>(bit_count / 64, 1), 0);
+        storage = storage_mode_t::bitstate;
+        auto count = inserted;
+        hashes.for_each([this](uint64_t hash){ insert(hash); });
+        inserted = count;
+        hashes.clear();
+    }
+
+    void compact_passed_set::clear() {
+        storage = storage_mode_t::full;
+        hashes.clear();
+        bits = {};
+        inserted = 0;
+    }
+
+    auto compact_passed_set::snapshot() -> compact_snapshot_t {
+        compact_snapshot_t result{storage, inserted, {}};
+        if(storage == storage_mode_t::bitstate)
+            result.words = bits;
+        else
+            hashes.for_each([&result](uint64_t hash){ result.words.push_back(hash); });
+        return result;
+    }
+
+    void compact_passed_set::restore(const compact_snapshot_t& snapshot) {
+        clear();
+        storage = snapshot.mode;
+        if(storage == storage_mode_t::bitstate) {
+            if(snapshot.words.empty())
+                throw std::out_of_range("bitstate passed set without bits");
+            bits = snapshot.words;
+        } else {
+            for(auto hash : snapshot.words)
+                hashes.insert(hash);
+            hashes.reclaim();
+        }
+        inserted = snapshot.inserted;
+    }
+}
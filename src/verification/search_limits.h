@@ -0,0 +1,69 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_SEARCH_LIMITS_H
+#define AALTITOAD_SEARCH_LIMITS_H
+#include "util/fingerprint_set.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace aaltitoad {
+    struct search_limits_t {
+        std::optional<size_t> memory_limit{}; // bytes of resident memory
+        std::optional<size_t> state_limit{};  // number of full states in the passed and waiting lists
+    };
+
+    // How new states are stored in the passed list.
+    //   full:            the full state with its parent link (exact, traceable)
+    //   hash_compaction: only a 64 bit hash of the state (collisions may prune unexplored states)
+    //   bitstate:        two bits in a fixed size bit array (more collisions, but constant memory)
+    enum class storage_mode_t {
+        full, hash_compaction, bitstate
+    };
+
+    // The contents of a compact_passed_set, such that it can be stored in a checkpoint
+    struct compact_snapshot_t {
+        storage_mode_t mode{storage_mode_t::full};
+        size_t inserted{};
+        std::vector<uint64_t> words{}; // the hashes, or the words of the bit array
+    };
+
+    // Passed set for the degraded storage modes
+    class compact_passed_set {
+    public:
+        auto mode() const -> storage_mode_t;
+        auto contains(size_t hash) const -> bool;
+        void insert(size_t hash);
+        auto size() const -> size_t; // number of inserted states
+        void switch_to_hash_compaction();
+        // moves the compacted hashes into a bit array of the provided size
+        void switch_to_bitstate(size_t bits);
+        void clear();
+        auto snapshot() -> compact_snapshot_t;
+        void restore(const compact_snapshot_t& snapshot);
+    private:
+        storage_mode_t storage{storage_mode_t::full};
+        concurrent_fingerprint_set hashes{};
+        std::vector<uint64_t> bits{};
+        size_t inserted{};
+        auto bit_indices(size_t hash) const -> std::pair<size_t, size_t>;
+    };
+}
+
+#endif //AALTITOAD_SEARCH_LIMITS_H
@@ -0,0 +1,39 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "search_metadata.h"
+
+namespace aaltitoad {
+    auto state_delta_t::from(const ntta_t::state_change_t& change) -> state_delta_t {
+        state_delta_t result{};
+        for(auto& location_change : change.location_changes)
+            result.components.insert(location_change.component->second.component_id);
+        for(auto& symbol_change : change.symbol_changes)
+            result.symbols.insert(symbol_change.id);
+        return result;
+    }
+
+    auto state_delta_t::from(const expr::symbol_table_t& tock_change, const symbol_interner_t& interner) -> state_delta_t {
+        state_delta_t result{};
+        for(auto& symbol : tock_change) {
+            auto id = interner.find(symbol.first);
+            if(id.has_value())
+                result.symbols.insert(id.value());
+        }
+        return result;
+    }
+}
@@ -0,0 +1,47 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_SEARCH_METADATA_H
+#define AALTITOAD_SEARCH_METADATA_H
+#include "expr-wrappers/symbol-interner.h"
+#include "ntta/tta.h"
+
+namespace aaltitoad {
+    // What a transition from a parent state touched
+    struct state_delta_t {
+        symbol_set_t symbols{};
+        symbol_set_t components{};
+        static auto from(const ntta_t::state_change_t& change) -> state_delta_t;
+        static auto from(const expr::symbol_table_t& tock_change, const symbol_interner_t& interner) -> state_delta_t;
+    };
+
+    // Bookkeeping stored alongside searched states
+    struct search_metadata_t {
+        std::optional<state_delta_t> delta{}; // no delta means the state must be fully checked
+        uint32_t depth{}; // number of ticks from the initial state
+        std::optional<uint32_t> compressed_parent{}; // root of the nearest tree compressed ancestor, see tree_compressed_store
+    };
+
+    // Work that is left for a waiting state, as a bitmask. A state can be waiting for both,
+    // e.g. when a tock successor equals a tick successor that is already waiting
+    enum pending_work_t : uint8_t {
+        pending_tick = 1, // tick successors are added
+        pending_tock = 2, // tock successors are added, a state without any is ticked instead
+    };
+}
+
+#endif //AALTITOAD_SEARCH_METADATA_H
@@ -0,0 +1,192 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "state_codec.h"
+
+namespace aaltitoad {
+    namespace {
+        auto read_byte(const uint8_t*& cursor, const uint8_t* end) -> uint8_t {
+            if(cursor >= end)
+                throw std::out_of_range("unexpected end of encoded state");
+            return *cursor++;
+        }
+    }
+
+    void write_varint(uint64_t value, bytes_t& out) {
+        while(value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    auto read_varint(const uint8_t*& cursor, const uint8_t* end) -> uint64_t {
+        uint64_t result = 0;
+        for(int shift = 0; shift < 64; shift += 7) {
+            auto byte = read_byte(cursor, end);
+            result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if((byte & 0x80) == 0)
+                return result;
+        }
+        throw std::out_of_range("malformed varint");
+    }
+
+    state_codec::state_codec(const ntta_t& s0) : prototype{s0}, layout{prototype} {
+        for(size_t i = 0; i < layout.components().size(); i++)
+            reference_locations.push_back(layout.location_id(prototype, i));
+        for(auto* table : {&prototype.symbols, &prototype.external_symbols}) {
+            for(auto& symbol : *table) {
+                reference_values.emplace_back();
+                encode(symbol.second, reference_values.back());
+            }
+        }
+    }
+
+    void state_codec::encode(const ntta_t& state, bytes_t& out) const {
+        for(size_t i = 0; i < layout.components().size(); i++)
+            write_varint(layout.location_id(state, i), out);
+        encode(state.symbols, out);
+        encode(state.external_symbols, out);
+    }
+
+    auto state_codec::encode(const ntta_t& state) const -> bytes_t {
+        bytes_t result{};
+        encode(state, result);
+        return result;
+    }
+
+    auto state_codec::decode(const uint8_t*& cursor, const uint8_t* end) const -> ntta_t {
+        auto state = prototype;
+        for(size_t i = 0; i < layout.components().size(); i++)
+            layout.set_location(state, i, read_varint(cursor, end));
+        decode(state.symbols, cursor, end);
+        decode(state.external_symbols, cursor, end);
+        return state;
+    }
+
+    auto state_codec::decode(const bytes_t& bytes) const -> ntta_t {
+        auto* cursor = bytes.data();
+        return decode(cursor, bytes.data() + bytes.size());
+    }
+
+    auto state_codec::fingerprint() const -> uint64_t {
+        size_t result{};
+        for(auto& component : layout.components()) {
+            result = ya::hash_combine(result, component.name);
+            for(auto& node : component.nodes)
+                result = ya::hash_combine(result, node->first);
+        }
+        for(auto& symbol : prototype.symbols)
+            result = ya::hash_combine(result, symbol.first);
+        for(auto& symbol : prototype.external_symbols)
+            result = ya::hash_combine(result, symbol.first);
+        return result;
+    }
+
+    void state_codec::encode(const expr::symbol_table_t& symbols, bytes_t& out) {
+        for(auto& symbol : symbols)
+            encode(symbol.second, out);
+    }
+
+    void state_codec::decode(expr::symbol_table_t& symbols, const uint8_t*& cursor, const uint8_t* end) {
+        for(auto& symbol : symbols)
+            decode(symbol.second, cursor, end);
+    }
+
+    void state_codec::encode(const expr::symbol_value_t& value, bytes_t& out) {
+        // a tag byte and a varint payload, strings are written inline as their size followed by their bytes
+        const std::string* string = nullptr;
+        auto tagged = to_tagged(value, [&string](const std::string& v) -> uint64_t { string = &v; return v.size(); });
+        out.push_back(static_cast<uint8_t>(tagged.tag));
+        write_varint(tagged.payload, out);
+        if(string)
+            out.insert(out.end(), string->begin(), string->end());
+    }
+
+    void state_codec::decode(expr::symbol_value_t& value, const uint8_t*& cursor, const uint8_t* end) {
+        auto tag = static_cast<value_tag_t>(read_byte(cursor, end));
+        auto payload = read_varint(cursor, end);
+        from_tagged({tag, payload}, [&cursor, end](uint64_t size) {
+            if(size > static_cast<uint64_t>(end - cursor))
+                throw std::out_of_range("unexpected end of encoded state");
+            std::string result{reinterpret_cast<const char*>(cursor), size};
+            cursor += size;
+            return result;
+        }, value);
+    }
+
+    void state_codec::encode_delta(const ntta_t& state, bytes_t& out) const {
+        // changed locations and changed symbols are written as (index + 1, value), each list ends with a 0
+        for(uint32_t i = 0; i < layout.components().size(); i++) {
+            auto id = layout.location_id(state, i);
+            if(id == reference_locations[i])
+                continue;
+            write_varint(i + 1, out);
+            write_varint(id, out);
+        }
+        write_varint(0, out);
+        bytes_t value{};
+        uint32_t index = 0;
+        for(auto* table : {&state.symbols, &state.external_symbols}) {
+            for(auto& symbol : *table) {
+                value.clear();
+                encode(symbol.second, value);
+                if(value != reference_values[index++]) {
+                    write_varint(index, out);
+                    out.insert(out.end(), value.begin(), value.end());
+                }
+            }
+        }
+        write_varint(0, out);
+    }
+
+    auto state_codec::encode_delta(const ntta_t& state) const -> encoded_state_t {
+        encoded_state_t result{};
+        encode_delta(state, result.bytes);
+        return result;
+    }
+
+    auto state_codec::decode_delta(const encoded_state_t& encoded) const -> ntta_t {
+        auto state = prototype;
+        auto* cursor = encoded.bytes.data();
+        auto* end = cursor + encoded.bytes.size();
+        for(auto i = read_varint(cursor, end); i != 0; i = read_varint(cursor, end)) {
+            if(i > layout.components().size())
+                throw std::out_of_range("encoded component does not exist");
+            layout.set_location(state, i - 1, read_varint(cursor, end));
+        }
+        // symbol indices are increasing, so the tables are walked once
+        auto* table = &state.symbols;
+        auto it = table->begin();
+        auto continue_in_externals = [&]() {
+            if(it == table->end() && table == &state.symbols)
+                it = (table = &state.external_symbols)->begin();
+        };
+        continue_in_externals();
+        uint64_t position = 1;
+        for(auto i = read_varint(cursor, end); i != 0; i = read_varint(cursor, end)) {
+            if(i < position || i > reference_values.size())
+                throw std::out_of_range("encoded symbol does not exist");
+            for(; position < i; position++) {
+                ++it;
+                continue_in_externals();
+            }
+            decode(it->second, cursor, end);
+        }
+        return state;
+    }
+}
@@ -0,0 +1,79 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_STATE_CODEC_H
+#define AALTITOAD_STATE_CODEC_H
+#include "state_layout.h"
+#include "util/hash_kernel.h"
+#include <cstdint>
+#include <vector>
+
+namespace aaltitoad {
+    using bytes_t = std::vector<uint8_t>;
+
+    // A state encoded as its difference to a reference state, see state_codec::encode_delta.
+    // The encoding is canonical, so equal states have equal encodings
+    struct encoded_state_t {
+        bytes_t bytes{};
+        auto operator==(const encoded_state_t& other) const -> bool {
+            return bytes.size() == other.bytes.size() && hashing::equal_bytes(bytes.data(), other.bytes.data(), bytes.size());
+        }
+    };
+
+    // LEB128-style variable length integers
+    void write_varint(uint64_t value, bytes_t& out);
+    auto read_varint(const uint8_t*& cursor, const uint8_t* end) -> uint64_t;
+
+    // Serializes states of one network into compact byte strings and back.
+    // The layout is taken from s0, so all states must belong to the same network
+    class state_codec {
+    public:
+        explicit state_codec(const ntta_t& s0);
+        void encode(const ntta_t& state, bytes_t& out) const; // appends to out
+        auto encode(const ntta_t& state) const -> bytes_t;
+        auto decode(const uint8_t*& cursor, const uint8_t* end) const -> ntta_t;
+        auto decode(const bytes_t& bytes) const -> ntta_t;
+        // only the locations and symbols that differ from s0 are written, so most states take a few bytes
+        void encode_delta(const ntta_t& state, bytes_t& out) const; // appends to out
+        auto encode_delta(const ntta_t& state) const -> encoded_state_t;
+        auto decode_delta(const encoded_state_t& encoded) const -> ntta_t;
+        // identifies the layout, such that data encoded for another network can be rejected
+        auto fingerprint() const -> uint64_t;
+
+    private:
+        ntta_t prototype;
+        state_layout_t layout;
+        std::vector<uint32_t> reference_locations{}; // location ids of s0, in component order
+        std::vector<bytes_t> reference_values{};     // encoded symbol values of s0, internal symbols first
+
+        static void encode(const expr::symbol_table_t& symbols, bytes_t& out);
+        static void decode(expr::symbol_table_t& symbols, const uint8_t*& cursor, const uint8_t* end);
+        static void encode(const expr::symbol_value_t& value, bytes_t& out);
+        static void decode(expr::symbol_value_t& value, const uint8_t*& cursor, const uint8_t* end);
+    };
+}
+
+namespace std {
+    template<>
+    struct hash<aaltitoad::encoded_state_t> {
+        inline auto operator()(const aaltitoad::encoded_state_t& v) const -> size_t {
+            return aaltitoad::hashing::hash_bytes(v.bytes.data(), v.bytes.size());
+        }
+    };
+}
+
+#endif //AALTITOAD_STATE_CODEC_H
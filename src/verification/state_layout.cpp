@@ -0,0 +1,103 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "state_layout.h"
+#include <algorithm>
+
+namespace aaltitoad {
+    state_layout_t::state_layout_t(const ntta_t& s0) : symbols{s0.symbols.size() + s0.external_symbols.size()} {
+        for(auto& component : s0.components) {
+            component_t c{component.first, {}, {}};
+            for(auto it = component.second.graph->nodes.begin(); it != component.second.graph->nodes.end(); it++) {
+                c.ids[&(*it)] = static_cast<uint32_t>(c.nodes.size());
+                c.nodes.push_back(it);
+            }
+            layout.push_back(std::move(c));
+        }
+        std::sort(layout.begin(), layout.end(), [](const component_t& a, const component_t& b){ return a.name < b.name; });
+    }
+
+    auto state_layout_t::components() const -> const std::vector<component_t>& {
+        return layout;
+    }
+
+    auto state_layout_t::location_id(const ntta_t& state, size_t component) const -> uint32_t {
+        auto& c = layout[component];
+        return c.ids.at(&(*state.components.at(c.name).current_location));
+    }
+
+    void state_layout_t::set_location(ntta_t& state, size_t component, uint64_t id) const {
+        auto& c = layout[component];
+        if(id >= c.nodes.size())
+            throw std::out_of_range(c.name + ": encoded location does not exist");
+        state.components.at(c.name).current_location = c.nodes[id];
+    }
+
+    auto state_layout_t::symbol_count() const -> size_t {
+        return symbols;
+    }
+
+    auto zigzag(int64_t v) -> uint64_t {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+
+    auto unzigzag(uint64_t v) -> int64_t {
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+
+    auto to_word(const tagged_value_t& value) -> uint64_t {
+        return (static_cast<uint64_t>(value.tag) << 61) | (value.payload & ((uint64_t{1} << 61) - 1));
+    }
+
+    auto from_word(uint64_t word) -> tagged_value_t {
+        return {static_cast<value_tag_t>(word >> 61), word & ((uint64_t{1} << 61) - 1)};
+    }
+
+    auto string_pool_t::intern(const std::string& s) -> uint64_t {
+        auto it = ids.find(s);
+        if(it == ids.end()) {
+            it = ids.emplace(s, strings.size()).first;
+            strings.push_back(s);
+        }
+        return it->second;
+    }
+
+    auto string_pool_t::find(const std::string& s) const -> std::optional<uint64_t> {
+        auto it = ids.find(s);
+        if(it == ids.end())
+            return {};
+        return it->second;
+    }
+
+    auto to_tagged(const expr::symbol_value_t& value, string_pool_t* pool, const string_pool_t& lookup) -> std::optional<tagged_value_t> {
+        auto known = true;
+        auto tagged = to_tagged(value, [&](const std::string& v) -> uint64_t {
+            if(pool)
+                return pool->intern(v);
+            auto id = lookup.find(v);
+            known = id.has_value();
+            return id.value_or(0);
+        });
+        if(!known)
+            return {};
+        return tagged;
+    }
+
+    auto string_pool_t::at(uint64_t id) const -> const std::string& {
+        return strings.at(id);
+    }
+}
@@ -0,0 +1,122 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_STATE_LAYOUT_H
+#define AALTITOAD_STATE_LAYOUT_H
+#include "ntta/tta.h"
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace aaltitoad {
+    // Canonical flat layout of the states of one network, shared by state_codec, tree_compressed_store and
+    // packed_state_store: the components ordered by name, with dense location ids, then the internal symbols and then
+    // the external symbols. Symbols are identified by their position, which relies on all states of a network sharing
+    // the same symbol order (see hash_symbol_values)
+    class state_layout_t {
+    public:
+        struct component_t {
+            std::string name;
+            std::vector<tta_t::graph_node_iterator_t> nodes;
+            std::unordered_map<const void*, uint32_t> ids;
+        };
+        explicit state_layout_t(const ntta_t& s0);
+        auto components() const -> const std::vector<component_t>&;
+        auto location_id(const ntta_t& state, size_t component) const -> uint32_t;
+        // throws std::out_of_range if the id does not exist
+        void set_location(ntta_t& state, size_t component, uint64_t id) const;
+        auto symbol_count() const -> size_t;
+    private:
+        std::vector<component_t> layout{};
+        size_t symbols{};
+    };
+
+    // Symbol values as a type tag and a 64 bit payload: zigzag encoded ints and clocks, the bits of floats,
+    // 0 or 1 for bools. How strings are represented is up to the store, e.g. interned ids
+    enum class value_tag_t : uint8_t {
+        _int, _float, _bool, _string, _clock
+    };
+    struct tagged_value_t {
+        value_tag_t tag;
+        uint64_t payload;
+    };
+
+    auto zigzag(int64_t v) -> uint64_t;
+    auto unzigzag(uint64_t v) -> int64_t;
+    // a tagged value in one word: the tag in the upper 3 bits and the lower 61 bits of the payload
+    auto to_word(const tagged_value_t& value) -> uint64_t;
+    auto from_word(uint64_t word) -> tagged_value_t;
+
+    // string_payload: const std::string& -> uint64_t
+    template<typename F>
+    auto to_tagged(const expr::symbol_value_t& value, F&& string_payload) -> tagged_value_t {
+        return std::visit(ya::overload(
+                [](const int& v) { return tagged_value_t{value_tag_t::_int, zigzag(v)}; },
+                [](const float& v) {
+                    uint32_t bits; std::memcpy(&bits, &v, sizeof(bits));
+                    return tagged_value_t{value_tag_t::_float, bits};
+                },
+                [](const bool& v) { return tagged_value_t{value_tag_t::_bool, v ? 1u : 0u}; },
+                [&string_payload](const std::string& v) { return tagged_value_t{value_tag_t::_string, string_payload(v)}; },
+                [](const expr::clock_t& v) { return tagged_value_t{value_tag_t::_clock, zigzag(static_cast<int64_t>(v.time_units))}; },
+                [](auto&&) -> tagged_value_t { throw std::logic_error("symbol type cannot be encoded"); }
+        ), static_cast<const expr::underlying_symbol_value_t&>(value));
+    }
+
+    // string_of: uint64_t -> std::string
+    template<typename F>
+    void from_tagged(const tagged_value_t& tagged, F&& string_of, expr::symbol_value_t& value) {
+        switch(tagged.tag) {
+            case value_tag_t::_int: value = static_cast<int>(unzigzag(tagged.payload)); break;
+            case value_tag_t::_float: {
+                auto bits = static_cast<uint32_t>(tagged.payload);
+                float v; std::memcpy(&v, &bits, sizeof(v));
+                value = v;
+                break;
+            }
+            case value_tag_t::_bool: value = tagged.payload != 0; break;
+            case value_tag_t::_string: value = string_of(tagged.payload); break;
+            case value_tag_t::_clock: {
+                using time_units_t = decltype(expr::clock_t::time_units);
+                value = expr::clock_t{static_cast<time_units_t>(unzigzag(tagged.payload))};
+                break;
+            }
+            default: throw std::out_of_range("unknown encoded value type");
+        }
+    }
+
+    // Interned strings of a store, such that string values get a fixed size payload
+    class string_pool_t {
+    public:
+        auto intern(const std::string& s) -> uint64_t;
+        auto find(const std::string& s) const -> std::optional<uint64_t>;
+        auto at(uint64_t id) const -> const std::string&;
+    private:
+        std::vector<std::string> strings{};
+        std::unordered_map<std::string, uint64_t> ids{};
+    };
+
+    // the tagged value, with strings interned into pool. Without a pool, strings are only looked up in lookup and
+    // nothing is returned for a string that was never interned, such that lookups of unknown states do not grow it
+    auto to_tagged(const expr::symbol_value_t& value, string_pool_t* pool, const string_pool_t& lookup) -> std::optional<tagged_value_t>;
+}
+
+#endif //AALTITOAD_STATE_LAYOUT_H
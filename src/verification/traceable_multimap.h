@@ -18,28 +18,50 @@
 #ifndef AALTITOAD_TRACEABLE_MULTIMAP_H
 #define AALTITOAD_TRACEABLE_MULTIMAP_H
 #include <map>
+#include <memory_resource>
+#include <functional>
+#include <queue>
 #include "pick_strategy.h"
 #include "util/exceptions/not_implemented_yet_exception.h"
 #include "util/random.h"
 #include "util/warnings.h"
 
 namespace aaltitoad {
-    template<typename T>
+    struct no_metadata_t {};
+
+    template<typename T, typename M = no_metadata_t>
     struct with_parent_t {
-        using parent_t = typename std::multimap<size_t, with_parent_t<T>>::iterator;
+        using parent_t = typename std::pmr::multimap<size_t, with_parent_t<T,M>>::iterator;
         std::optional<parent_t> parent;
         T data;
+        M metadata{};
     };
 
-    template<typename T>
+    template<typename T, typename M = no_metadata_t>
     class traceable_multimap {
-        std::multimap<size_t, with_parent_t<T>> data{};
+        std::pmr::multimap<size_t, with_parent_t<T,M>> data{};
+    public:
+        using iterator_t = typename std::pmr::multimap<size_t, with_parent_t<T,M>>::iterator;
+        using heuristic_t = std::function<double(const T&)>; // lower is better
+    private:
+        struct frontier_entry_t {
+            double score;
+            size_t sequence;
+            iterator_t it;
+            auto operator>(const frontier_entry_t& o) const -> bool {
+                return score > o.score || (score == o.score && sequence > o.sequence);
+            }
+        };
+        heuristic_t heuristic{};
+        std::priority_queue<frontier_entry_t, std::vector<frontier_entry_t>, std::greater<>> frontier{};
+        size_t sequence{};
     public:
-        using iterator_t = typename std::multimap<size_t, with_parent_t<T>>::iterator;
         traceable_multimap(std::initializer_list<T> ts) : data{} {
             for(auto t : ts)
                 add(t);
         }
+        // nodes are allocated from the resource, which is kept when the map is assigned to
+        explicit traceable_multimap(std::pmr::memory_resource* resource) : data{resource} {}
         auto begin() {
             return data.begin();
         }
@@ -55,13 +77,30 @@ namespace aaltitoad {
         auto add(const std::optional<iterator_t>& parent, const T& v) {
             return add(std::hash<T>{}(v), parent, v);
         }
-        auto add(size_t key, const std::optional<iterator_t>& parent, const T& v) {
-            return data.insert({key, {parent, v}});
+        auto add(const std::optional<iterator_t>& parent, const T& v, const M& metadata) {
+            return add(std::hash<T>{}(v), parent, v, metadata);
+        }
+        auto add(size_t key, const std::optional<iterator_t>& parent, const T& v, const M& metadata = {}) {
+            auto it = data.insert({key, {parent, v, metadata}});
+            if(heuristic)
+                frontier.push({heuristic(v), sequence++, it});
+            return it;
+        }
+        // Only elements added after setting the heuristic are scored. Mixing best_first with other pick strategies is not supported
+        void set_heuristic(heuristic_t h) {
+            heuristic = std::move(h);
         }
-        void add_if_not_contains(const std::optional<iterator_t>& parent, const T& v) {
+        void add_if_not_contains(const std::optional<iterator_t>& parent, const T& v, const M& metadata = {}) {
             if(contains(v))
                 return;
-            add(parent, v);
+            add(parent, v, metadata);
+        }
+        auto find(const T& v) -> iterator_t {
+            auto range = data.equal_range(std::hash<T>{}(v));
+            for(auto it = range.first; it != range.second; it++)
+                if(it->second.data == v)
+                    return it;
+            return data.end();
         }
         auto contains(const T& v) const -> bool {
             return contains(std::hash<T>{}(v), v);
@@ -73,16 +112,17 @@ namespace aaltitoad {
                     return true;
             return false;
         }
-        auto pop(const pick_strategy& strategy = pick_strategy::first) -> with_parent_t<T> {
+        auto pop(const pick_strategy& strategy = pick_strategy::first) -> with_parent_t<T,M> {
             switch (strategy) {
                 case pick_strategy::first:  return pop_it(data.begin());
                 case pick_strategy::last:   return pop_it(last_it());
                 case pick_strategy::random: return pop_it(random_it());
+                case pick_strategy::best_first: return pop_it(best_it());
                 default:
                     throw not_implemented_yet_exception();
             }
         }
-        auto pop_it(const iterator_t& it) -> with_parent_t<T> {
+        auto pop_it(const iterator_t& it) -> with_parent_t<T,M> {
             auto r = it->second;
             data.erase(it);
             return r;
@@ -93,6 +133,13 @@ namespace aaltitoad {
             for (auto i = 0; i < pick; i++, it++);
             return it;
         }
+        auto best_it() -> iterator_t {
+            if(frontier.empty())
+                throw std::logic_error("best_first pick strategy requires a heuristic to be set before adding elements");
+            auto it = frontier.top().it;
+            frontier.pop();
+            return it;
+        }
         auto last_it() -> iterator_t {
             auto it = data.begin();
             for(auto i = 0; i < data.size()-1; i++, it++);
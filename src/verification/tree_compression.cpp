@@ -0,0 +1,198 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "tree_compression.h"
+#include <algorithm>
+
+namespace aaltitoad {
+    auto tree_compressed_store::node_table_t::hash(uint64_t left, uint64_t right) -> uint64_t {
+        // splitmix64 finalizer over both children
+        auto h = left * 0x9e3779b97f4a7c15ull ^ (right + 0x632be59bd9b4e019ull);
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        return h ^ (h >> 31);
+    }
+
+    auto tree_compressed_store::node_table_t::find(uint64_t left, uint64_t right) const -> std::optional<uint32_t> {
+        if(slots.empty())
+            return {};
+        auto mask = slots.size() - 1;
+        for(auto i = hash(left, right) & mask; slots[i] != 0; i = (i + 1) & mask) {
+            auto& entry = entries[slots[i] - 1];
+            if(entry.first == left && entry.second == right)
+                return slots[i] - 1;
+        }
+        return {};
+    }
+
+    auto tree_compressed_store::node_table_t::intern(uint64_t left, uint64_t right) -> std::pair<uint32_t, bool> {
+        if((entries.size() + 1) * 2 > slots.size())
+            grow();
+        auto mask = slots.size() - 1;
+        auto i = hash(left, right) & mask;
+        for(; slots[i] != 0; i = (i + 1) & mask) {
+            auto& entry = entries[slots[i] - 1];
+            if(entry.first == left && entry.second == right)
+                return {slots[i] - 1, false};
+        }
+        entries.emplace_back(left, right);
+        slots[i] = static_cast<uint32_t>(entries.size());
+        return {static_cast<uint32_t>(entries.size() - 1), true};
+    }
+
+    void tree_compressed_store::node_table_t::grow() {
+        slots.assign(std::max<size_t>(slots.size() * 2, 16), 0);
+        auto mask = slots.size() - 1;
+        for(uint32_t e = 0; e < entries.size(); e++) {
+            auto i = hash(entries[e].first, entries[e].second) & mask;
+            while(slots[i] != 0)
+                i = (i + 1) & mask;
+            slots[i] = e + 1;
+        }
+    }
+
+    auto tree_compressed_store::node_table_t::at(uint32_t index) const -> const std::pair<uint64_t, uint64_t>& {
+        return entries.at(index);
+    }
+
+    auto tree_compressed_store::node_table_t::size() const -> size_t {
+        return entries.size();
+    }
+
+    auto tree_compressed_store::node_table_t::memory_bytes() const -> size_t {
+        return entries.capacity() * sizeof(std::pair<uint64_t, uint64_t>) + slots.capacity() * sizeof(uint32_t);
+    }
+
+    tree_compressed_store::tree_compressed_store(const ntta_t& s0) : prototype{s0}, layout{prototype} {
+        // a single leaf is padded, such that the root is always a pair
+        leaf_count = std::max<size_t>(layout.components().size() + layout.symbol_count(), 2);
+        build_tree(0, leaf_count);
+        tables.resize(nodes.size());
+    }
+
+    auto tree_compressed_store::build_tree(size_t lo, size_t hi) -> size_t { // NOLINT(misc-no-recursion)
+        auto index = nodes.size();
+        nodes.push_back({lo, hi, {}, {}});
+        if(hi - lo == 1)
+            return index;
+        auto mid = lo + (hi - lo) / 2;
+        auto left = build_tree(lo, mid);
+        auto right = build_tree(mid, hi);
+        nodes[index].left = left;
+        nodes[index].right = right;
+        return index;
+    }
+
+
+    void tree_compressed_store::decode_value(uint64_t leaf, expr::symbol_value_t& value) const {
+        from_tagged(from_word(leaf), [this](uint64_t id){ return strings.at(id); }, value);
+    }
+
+    auto tree_compressed_store::flatten(const ntta_t& state, string_pool_t* pool) const -> std::optional<std::vector<uint64_t>> {
+        std::vector<uint64_t> leaves{};
+        leaves.reserve(leaf_count);
+        for(size_t c = 0; c < layout.components().size(); c++)
+            leaves.push_back(layout.location_id(state, c));
+        for(auto* table : {&state.symbols, &state.external_symbols}) {
+            for(auto& symbol : *table) {
+                auto tagged = to_tagged(symbol.second, pool, strings);
+                if(!tagged.has_value())
+                    return {};
+                leaves.push_back(to_word(tagged.value()));
+            }
+        }
+        leaves.resize(leaf_count, 0);
+        return leaves;
+    }
+
+    auto tree_compressed_store::intern(size_t node, const std::vector<uint64_t>& leaves, bool& inserted) -> uint64_t { // NOLINT(misc-no-recursion)
+        auto& n = nodes[node];
+        if(!n.left.has_value())
+            return leaves[n.lo];
+        auto left = intern(n.left.value(), leaves, inserted);
+        auto right = intern(n.right.value(), leaves, inserted);
+        auto result = tables[node].intern(left, right);
+        inserted = result.second;
+        return result.first;
+    }
+
+    auto tree_compressed_store::lookup(size_t node, const std::vector<uint64_t>& leaves) const -> std::optional<uint64_t> { // NOLINT(misc-no-recursion)
+        auto& n = nodes[node];
+        if(!n.left.has_value())
+            return leaves[n.lo];
+        auto left = lookup(n.left.value(), leaves);
+        if(!left.has_value())
+            return {};
+        auto right = lookup(n.right.value(), leaves);
+        if(!right.has_value())
+            return {};
+        return tables[node].find(left.value(), right.value());
+    }
+
+    void tree_compressed_store::expand(size_t node, uint64_t value, std::vector<uint64_t>& leaves) const { // NOLINT(misc-no-recursion)
+        auto& n = nodes[node];
+        if(!n.left.has_value()) {
+            leaves[n.lo] = value;
+            return;
+        }
+        auto& pair = tables[node].at(static_cast<uint32_t>(value));
+        expand(n.left.value(), pair.first, leaves);
+        expand(n.right.value(), pair.second, leaves);
+    }
+
+    auto tree_compressed_store::insert(const ntta_t& state) -> std::pair<root_t, bool> {
+        auto inserted = false;
+        auto root = intern(0, flatten(state, &strings).value(), inserted);
+        return {static_cast<root_t>(root), inserted};
+    }
+
+    auto tree_compressed_store::find(const ntta_t& state) const -> std::optional<root_t> {
+        // a state with a string that was never interned has never been stored
+        auto leaves = flatten(state, nullptr);
+        if(!leaves.has_value())
+            return {};
+        auto root = lookup(0, leaves.value());
+        if(!root.has_value())
+            return {};
+        return static_cast<root_t>(root.value());
+    }
+
+    auto tree_compressed_store::decode(root_t root) const -> ntta_t {
+        std::vector<uint64_t> leaves(leaf_count, 0);
+        expand(0, root, leaves);
+        auto state = prototype;
+        size_t i = 0;
+        for(; i < layout.components().size(); i++)
+            layout.set_location(state, i, leaves[i]);
+        for(auto& symbol : state.symbols)
+            decode_value(leaves[i++], symbol.second);
+        for(auto& symbol : state.external_symbols)
+            decode_value(leaves[i++], symbol.second);
+        return state;
+    }
+
+    auto tree_compressed_store::size() const -> size_t {
+        return tables[0].size();
+    }
+
+    auto tree_compressed_store::memory_bytes() const -> size_t {
+        size_t result = 0;
+        for(auto& table : tables)
+            result += table.memory_bytes();
+        return result;
+    }
+}
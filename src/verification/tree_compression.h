@@ -0,0 +1,79 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef AALTITOAD_TREE_COMPRESSION_H
+#define AALTITOAD_TREE_COMPRESSION_H
+#include "compressed_state_store.h"
+#include "state_layout.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace aaltitoad {
+    // Lossless state store with tree compression, as in LTSmin. A state is flattened into a vector of 64 bit leaves
+    // (component locations, then symbol values), which is recursively split in halves. Every internal tree node has
+    // its own table of (left, right) pairs, where children are either leaves or indices into the child's table.
+    // States that share a sub-vector share its table entries, so a stored state costs roughly one new pair per
+    // changed leaf per tree level, and is identified by the index of its root pair
+    class tree_compressed_store : public compressed_state_store {
+    public:
+        using root_t = index_t;
+        explicit tree_compressed_store(const ntta_t& s0);
+        // the root of the state, and whether the state was not already stored
+        auto insert(const ntta_t& state) -> std::pair<root_t, bool> override;
+        auto find(const ntta_t& state) const -> std::optional<root_t> override;
+        auto decode(root_t root) const -> ntta_t override;
+        auto size() const -> size_t override;
+        auto memory_bytes() const -> size_t override;
+
+    private:
+        // open addressing table of interned pairs
+        class node_table_t {
+        public:
+            auto intern(uint64_t left, uint64_t right) -> std::pair<uint32_t, bool>;
+            auto find(uint64_t left, uint64_t right) const -> std::optional<uint32_t>;
+            auto at(uint32_t index) const -> const std::pair<uint64_t, uint64_t>&;
+            auto size() const -> size_t;
+            auto memory_bytes() const -> size_t;
+        private:
+            std::vector<std::pair<uint64_t, uint64_t>> entries{};
+            std::vector<uint32_t> slots{}; // entry index + 1, 0 is empty
+            void grow();
+            static auto hash(uint64_t left, uint64_t right) -> uint64_t;
+        };
+        struct node_t {
+            size_t lo, hi;
+            std::optional<size_t> left, right; // child nodes, or nothing for leaves
+        };
+        ntta_t prototype;
+        state_layout_t layout;
+        std::vector<node_t> nodes{};
+        mutable std::vector<node_table_t> tables{}; // one per node
+        string_pool_t strings{};
+        size_t leaf_count{};
+
+        auto build_tree(size_t lo, size_t hi) -> size_t;
+        // strings are interned into pool, without a pool nothing is returned for strings that are not interned
+        auto flatten(const ntta_t& state, string_pool_t* pool) const -> std::optional<std::vector<uint64_t>>;
+        void decode_value(uint64_t leaf, expr::symbol_value_t& value) const;
+        auto intern(size_t node, const std::vector<uint64_t>& leaves, bool& inserted) -> uint64_t;
+        auto lookup(size_t node, const std::vector<uint64_t>& leaves) const -> std::optional<uint64_t>;
+        void expand(size_t node, uint64_t value, std::vector<uint64_t>& leaves) const;
+    };
+}
+
+#endif //AALTITOAD_TREE_COMPRESSION_H
@@ -0,0 +1,195 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "expr-wrappers/interpreter.h"
+#include "expr-wrappers/expression-simplifier.h"
+#include <ntta/builder/ntta_builder.h>
+#include <verification/cone_of_influence.h>
+#include <verification/dead_variable_reduction.h>
+#include "expr-wrappers/ctl-interpreter.h"
+#include <catch2/catch_test_macros.hpp>
+
+SCENARIO("simplifying expressions at model build time", "[expression_simplifier]") {
+    spdlog::set_level(spdlog::level::trace);
+    aaltitoad::expression_driver compiler{};
+    aaltitoad::expression_simplifier simplifier{};
+    auto as_string = [](const expr::syntax_tree_t& t) -> std::string { std::stringstream ss{}; ss << t; return ss.str(); };
+    auto expected = [&compiler, &as_string](const std::string& s) -> std::string {
+        aaltitoad::expression_simplifier other{};
+        return as_string(other.simplify(compiler.parse_guard(s)));
+    };
+    GIVEN("a guard with a trivially true conjunct") {
+        auto guard = compiler.parse_guard("3 == 3 && x > 2");
+        WHEN("simplifying the guard") {
+            auto result = simplifier.simplify(guard);
+            THEN("the trivially true conjunct is removed") {
+                REQUIRE(as_string(result) == expected("x > 2"));
+                REQUIRE(simplifier.get_statistics().nodes_eliminated > 0);
+            }
+        }
+    }
+    GIVEN("a comparison with the literal on the left-hand side") {
+        auto guard = compiler.parse_guard("2 < x");
+        WHEN("simplifying the guard") {
+            auto result = simplifier.simplify(guard);
+            THEN("the comparison is canonicalized") {
+                REQUIRE(as_string(result) == expected("x > 2"));
+            }
+        }
+    }
+    GIVEN("a statically false guard") {
+        auto guard = compiler.parse_guard("1 > 2 && x > 0");
+        WHEN("simplifying the guard") {
+            auto result = simplifier.simplify(guard);
+            THEN("the guard is recognized as constant false") {
+                REQUIRE(aaltitoad::expression_simplifier::is_constant_false(result));
+            }
+        }
+    }
+    GIVEN("a tta with a statically disabled edge") {
+        aaltitoad::tta_builder builder{&compiler};
+        builder.add_locations({"L0", "L1"})
+               .set_starting_location("L0")
+               .add_edges({{"L0", "L1", "1 > 2", ""}, {"L0", "L1", "x > 0", ""}});
+        WHEN("building the tta") {
+            auto tta = builder.build();
+            THEN("the statically disabled edge is dropped") {
+                REQUIRE(1 == tta.graph->edges.size());
+                REQUIRE(1 == builder.get_statistics().edges_eliminated);
+            }
+        }
+    }
+}
+
+SCENARIO("read/write set analysis of built networks", "[read_write_analysis]") {
+    spdlog::set_level(spdlog::level::trace);
+    aaltitoad::ntta_builder builder{};
+    aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+    GIVEN("a tta reading 'x' and 'y' and writing 'z'") {
+        auto n = builder
+                .add_symbols({{"x", 0}, {"y", 0}, {"z", 0}, {"w", 0}})
+                .add_tta("A", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0", "L1"})
+                        .set_starting_location("L0")
+                        .add_edge({"L0", "L1", "x > 0", "z := y + 1"}))
+                .build();
+        auto id = [&n](const std::string& name){ return n.interner->find(name).value(); };
+        WHEN("looking at the analysed edge") {
+            auto& edge = n.components.at("A").graph->nodes.at("L0").outgoing_edges[0]->second.data;
+            THEN("the guard and update reads are in the read set") {
+                REQUIRE(edge.reads.contains(id("x")));
+                REQUIRE(edge.reads.contains(id("y")));
+                REQUIRE_FALSE(edge.reads.contains(id("w")));
+            }
+            AND_THEN("only the assigned symbol is in the write set") {
+                REQUIRE(edge.writes.contains(id("z")));
+                REQUIRE(1 == edge.writes.size());
+            }
+        }
+        WHEN("looking at the analysed locations") {
+            auto& l0 = n.components.at("A").graph->nodes.at("L0").data;
+            auto& l1 = n.components.at("A").graph->nodes.at("L1").data;
+            THEN("the source location inherits the edge sets") {
+                REQUIRE(l0.reads.contains(id("x")));
+                REQUIRE(l0.writes.contains(id("z")));
+            }
+            AND_THEN("the location without outgoing edges has empty sets") {
+                REQUIRE(l1.reads.empty());
+                REQUIRE(l1.writes.empty());
+            }
+        }
+    }
+}
+
+SCENARIO("cone-of-influence slicing", "[slicing]") {
+    spdlog::set_level(spdlog::level::trace);
+    aaltitoad::ntta_builder builder{};
+    aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+    auto n = builder
+            .add_symbols({{"x", 0}, {"y", 0}, {"z", 0}, {"w", 0}})
+            .add_tta("A", aaltitoad::tta_builder{&compiler}
+                    .add_locations({"A0", "A1"})
+                    .set_starting_location("A0")
+                    .add_edge({"A0", "A1", "y > 0", "x := 1"}))
+            .add_tta("B", aaltitoad::tta_builder{&compiler}
+                    .add_locations({"B0", "B1"})
+                    .set_starting_location("B0")
+                    .add_edge({"B0", "B1", "", "y := 1"}))
+            .add_tta("C", aaltitoad::tta_builder{&compiler}
+                    .add_locations({"C0", "C1"})
+                    .set_starting_location("C0")
+                    .add_edge({"C0", "C1", "w > 0", "z := 1"}))
+            .build();
+    aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+    GIVEN("a query about 'x'") {
+        aaltitoad::slice_statistics_t statistics{};
+        auto sliced = aaltitoad::slice(n, {interpreter.compile("E F x == 1")}, statistics);
+        THEN("the writer of 'x' and the writer of its guard dependency are kept") {
+            REQUIRE(sliced.components.contains("A"));
+            REQUIRE(sliced.components.contains("B"));
+        }
+        AND_THEN("the unrelated component and its symbols are sliced away") {
+            REQUIRE_FALSE(sliced.components.contains("C"));
+            REQUIRE_FALSE(sliced.symbols.contains("z"));
+            REQUIRE_FALSE(sliced.symbols.contains("w"));
+            REQUIRE(statistics.components_after == 2);
+        }
+    }
+    GIVEN("a query about a location of 'C'") {
+        aaltitoad::slice_statistics_t statistics{};
+        auto sliced = aaltitoad::slice(n, {interpreter.compile("E F C1")}, statistics);
+        THEN("only 'C' is kept") {
+            REQUIRE(sliced.components.size() == 1);
+            REQUIRE(sliced.components.contains("C"));
+            REQUIRE(sliced.symbols.contains("w"));
+        }
+    }
+}
+
+SCENARIO("dead variable reduction", "[dead_variables]") {
+    spdlog::set_level(spdlog::level::trace);
+    aaltitoad::ntta_builder builder{};
+    aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+    auto n = builder
+            .add_symbols({{"x", 0}, {"q", 0}})
+            .add_tta("A", aaltitoad::tta_builder{&compiler}
+                    .add_locations({"L0", "L1"})
+                    .set_starting_location("L0")
+                    .add_edges({{"L0", "L1", "", "x := 7"}, {"L1", "L0", "x > 3", "q := q + 1"}}))
+            .build();
+    aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+    aaltitoad::dead_variable_reducer reducer{n, {interpreter.compile("E F q == 2")}};
+    GIVEN("a state in L0 where 'x' is about to be overwritten") {
+        auto s = n;
+        s.symbols["x"] = 7;
+        s.symbols["q"] = 1;
+        reducer.reduce(s);
+        THEN("'x' is reset to its initial value") {
+            REQUIRE(std::get<bool>(s.symbols.at("x") == 0));
+        }
+        AND_THEN("the queried symbol keeps its value") {
+            REQUIRE(std::get<bool>(s.symbols.at("q") == 1));
+        }
+    }
+    GIVEN("a state in L1 where 'x' is read by the outgoing guard") {
+        auto s = n + n.tick()[0];
+        reducer.reduce(s);
+        THEN("'x' keeps its value") {
+            REQUIRE(std::get<bool>(s.symbols.at("x") == 7));
+        }
+    }
+}
@@ -19,6 +19,7 @@
 #include "expr-wrappers/interpreter.h"
 #include "symbol_table.h"
 #include <ntta/tta.h>
+#include <ntta/builder/ntta_builder.h>
 #include <catch2/catch_test_macros.hpp>
 #include <utility>
 
@@ -284,9 +285,10 @@ SCENARIO("ticking result in maximal behavior (no tockers registered)", "[tick-ma
                 REQUIRE(2 == changes.size());
                 bool found_a = false, found_b = false, found_nonsense = false;
                 for(auto& change : changes) {
-                    found_a |= std::get<bool>(ee_(change.symbol_changes["x"],1));
-                    found_b |= std::get<bool>(ee_(change.symbol_changes["x"],2));
-                    found_nonsense |= std::get<bool>(ee_(change.symbol_changes["x"],3));
+                    auto symbol_changes = change.to_symbol_table(*n.interner);
+                    found_a |= std::get<bool>(ee_(symbol_changes["x"],1));
+                    found_b |= std::get<bool>(ee_(symbol_changes["x"],2));
+                    found_nonsense |= std::get<bool>(ee_(symbol_changes["x"],3));
                 }
                 REQUIRE(found_a);
                 REQUIRE(found_b);
@@ -335,3 +337,63 @@ SCENARIO("ticking result in maximal behavior (no tockers registered)", "[tick-ma
         }
     }
 }
+
+SCENARIO("applying changes in place and reverting them", "[ntta_t-undo]") {
+    spdlog::set_level(spdlog::level::trace);
+    aaltitoad::ntta_builder builder{};
+    aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+    auto n = builder
+            .add_symbols({{"x", 0}, {"y", 0}})
+            .add_external_symbols({{"e", false}})
+            .add_tta("A", aaltitoad::tta_builder{&compiler}
+                    .add_locations({"L0", "L1"})
+                    .set_starting_location("L0")
+                    .add_edge({"L0", "L1", "", "x := 1; y := x + 2"}))
+            .build();
+    auto original = n;
+    aaltitoad::ntta_t::undo_t undo{};
+    GIVEN("a tick change applied in place") {
+        auto change = n.tick()[0];
+        n.apply(change, undo);
+        THEN("the state is the same as the copied successor") {
+            REQUIRE(n == original + change);
+            REQUIRE_FALSE(undo.empty());
+        }
+        WHEN("reverting the change") {
+            n.revert(undo);
+            THEN("the original state is restored") {
+                REQUIRE(n == original);
+                REQUIRE(undo.empty());
+            }
+        }
+    }
+    GIVEN("a tock change applied on top of a tick change") {
+        auto change = n.tick()[0];
+        expr::symbol_table_t tock{};
+        tock["e"] = true;
+        tock["x"] = 5;
+        n.apply(change, undo);
+        n.apply(tock, undo);
+        THEN("both changes are visible") {
+            REQUIRE(std::get<bool>(n.external_symbols.at("e") == true));
+            REQUIRE(std::get<bool>(n.symbols.at("x") == 5));
+        }
+        WHEN("reverting both changes") {
+            n.revert(undo);
+            THEN("the original state is restored") {
+                REQUIRE(n == original);
+            }
+        }
+    }
+    GIVEN("a change applied to a copy of a state that has already applied a change") {
+        auto change = n.tick()[0];
+        n.apply(change, undo);
+        n.revert(undo);
+        auto copy = n;
+        copy.apply(change);
+        THEN("only the copy is changed") {
+            REQUIRE(n == original);
+            REQUIRE(copy == original + change);
+        }
+    }
+}
@@ -0,0 +1,118 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "expr-wrappers/ctl-interpreter.h"
+#include <ntta/tta.h>
+#include <catch2/catch_test_macros.hpp>
+#include <ntta/builder/ntta_builder.h>
+#include <verification/ctl/ctl_sat.h>
+#include <verification/ctl/compiled_predicate.h>
+#include <verification/ctl/global_ctl_checker.h>
+
+SCENARIO("compiled state predicates agree with the ctl tree", "[compiled_predicate]") {
+    spdlog::set_level(spdlog::level::trace);
+    aaltitoad::ntta_builder builder{};
+    aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+    auto n = builder
+            .add_symbols({{"x", 5}, {"b", true}})
+            .add_tta("A", aaltitoad::tta_builder{&compiler}
+                    .add_locations({"L0", "L1"})
+                    .set_starting_location("L0")
+                    .add_edges({{"L0", "L1", "x > 0", "x := x - 1"}, {"L1", "L0"}}))
+            .build();
+    aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+    auto states = std::vector<aaltitoad::ntta_t>{n};
+    for(auto& change : n.tick())
+        states.push_back(n + change);
+    for(auto& query_string : {"E F x == 5", "E F 4 < x", "E F x > 4 && L0", "E F !L1 || b", "E F (x + 1) == 5", "E F L1 -> x == 4"}) {
+        GIVEN(std::string{"the query '"} + query_string + "'") {
+            auto query = interpreter.compile(query_string);
+            aaltitoad::compiled_predicate_t predicate{query, n};
+            THEN("the compiled predicate has the same truth value as the tree in every state") {
+                for(auto& state : states)
+                    REQUIRE(predicate.evaluate(state) == aaltitoad::is_satisfied(query, state));
+            }
+        }
+    }
+}
+
+SCENARIO("compiled state predicates know their support", "[compiled_predicate]") {
+    spdlog::set_level(spdlog::level::trace);
+    aaltitoad::ntta_builder builder{};
+    aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+    auto n = builder
+            .add_symbols({{"x", 5}, {"y", 0}})
+            .add_tta("A", aaltitoad::tta_builder{&compiler}
+                    .add_locations({"L0", "L1"})
+                    .set_starting_location("L0")
+                    .add_edges({{"L0", "L1", "", "y := 1"}}))
+            .build();
+    aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+    auto delta = aaltitoad::state_delta_t::from(n.tick()[0]);
+    GIVEN("a query that only mentions 'x'") {
+        aaltitoad::compiled_predicate_t predicate{interpreter.compile("E F x == 0"), n};
+        THEN("a transition that moves 'A' and writes 'y' does not affect it") {
+            REQUIRE_FALSE(predicate.is_affected_by(delta));
+        }
+    }
+    GIVEN("a query that mentions a location of 'A'") {
+        aaltitoad::compiled_predicate_t predicate{interpreter.compile("E F L1"), n};
+        THEN("a transition that moves 'A' affects it") {
+            REQUIRE(predicate.is_affected_by(delta));
+        }
+    }
+    GIVEN("a query that mentions 'y'") {
+        aaltitoad::compiled_predicate_t predicate{interpreter.compile("E F y + x > 5"), n};
+        THEN("a transition that writes 'y' affects it") {
+            REQUIRE(predicate.is_affected_by(delta));
+        }
+    }
+}
+
+SCENARIO("global ctl checking on an explicit state graph", "[global_ctl]") {
+    spdlog::set_level(spdlog::level::trace);
+    aaltitoad::ntta_builder builder{};
+    aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+    auto n = builder
+            .add_symbols({{"x", 3}})
+            .add_tta("A", aaltitoad::tta_builder{&compiler}
+                    .add_locations({"L0", "L1"})
+                    .set_starting_location("L0")
+                    .add_edges({{"L0", "L1", "x > 0", "x := x - 1"}, {"L1", "L0"}}))
+            .build_with_interesting_tocker();
+    aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+    aaltitoad::global_ctl_checker checker{n};
+    GIVEN("the count-down state graph") {
+        THEN("all states are enumerated once") {
+            REQUIRE(checker.state_count() == 7);
+        }
+    }
+    for(auto& query_string : {"E F x == 0", "A F x == 0", "A G x >= 0", "E X x == 2", "A G E F x == 0", "E F A G x == 0"}) {
+        GIVEN(std::string{"the satisfied query '"} + query_string + "'") {
+            THEN("it holds in the initial state") {
+                REQUIRE(checker.is_satisfied(interpreter.compile(query_string)));
+            }
+        }
+    }
+    for(auto& query_string : {"A G x > 0", "E G x > 0", "A X x == 3"}) {
+        GIVEN(std::string{"the unsatisfied query '"} + query_string + "'") {
+            THEN("it does not hold in the initial state") {
+                REQUIRE_FALSE(checker.is_satisfied(interpreter.compile(query_string)));
+            }
+        }
+    }
+}
@@ -21,6 +21,13 @@
 #include <catch2/catch_test_macros.hpp>
 #include <ntta/builder/ntta_builder.h>
 #include <verification/forward_reachability.h>
+#include <verification/liveness_searcher.h>
+#include <verification/bounded_model_checker.h>
+#include <verification/depth_bounded_searcher.h>
+#include <verification/checkpoint.h>
+#include <verification/external_memory_searcher.h>
+#include <csignal>
+#include <filesystem>
 
 SCENARIO("basic reachability", "[frs]") {
     spdlog::set_level(spdlog::level::trace);
@@ -169,3 +176,529 @@ SCENARIO("basic reachability", "[frs]") {
         }
     }
 }
+
+SCENARIO("safety checking", "[frs]") {
+    spdlog::set_level(spdlog::level::trace);
+    GIVEN("one tta with a simple count-down loop") {
+        aaltitoad::ntta_builder builder{};
+        aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+        auto n = builder
+                .add_symbols({{"x", 5}})
+                .add_tta("A", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0", "L1"})
+                        .set_starting_location("L0")
+                        .add_edges({{"L0", "L1", "x > 0", "x := x - 1"}, {"L1", "L0"}}))
+                .build_with_interesting_tocker();
+        GIVEN("a safety query that holds 'A G x >= 0'") {
+            auto query = aaltitoad::ctl_interpreter{n.symbols, n.external_symbols}.compile("A G x >= 0");
+            WHEN("searching through the state-space with forward reachability search") {
+                aaltitoad::forward_reachability_searcher frs{};
+                auto results = frs.is_reachable(n, query);
+                THEN("the query holds and there is no counterexample") {
+                    REQUIRE(results.size() == 1);
+                    REQUIRE(results.begin()->holds());
+                    REQUIRE(!results.begin()->solution.has_value());
+                }
+            }
+        }
+        GIVEN("a violated safety query 'A G x > 0'") {
+            auto query = aaltitoad::ctl_interpreter{n.symbols, n.external_symbols}.compile("A G x > 0");
+            WHEN("searching through the state-space with forward reachability search") {
+                aaltitoad::forward_reachability_searcher frs{};
+                auto results = frs.is_reachable(n, query);
+                THEN("the query does not hold") {
+                    REQUIRE(!results.begin()->holds());
+                }
+                AND_THEN("the counterexample ends in a state where 'x' is 0") {
+                    REQUIRE(std::get<bool>(results.begin()->solution.value()->second.data.symbols.at("x") == 0));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("liveness checking", "[liveness]") {
+    spdlog::set_level(spdlog::level::trace);
+    GIVEN("one tta with a simple count-down loop that deadlocks when x reaches 0") {
+        aaltitoad::ntta_builder builder{};
+        aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+        auto n = builder
+                .add_symbols({{"x", 3}})
+                .add_tta("A", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0", "L1"})
+                        .set_starting_location("L0")
+                        .add_edges({{"L0", "L1", "x > 0", "x := x - 1"}, {"L1", "L0"}}))
+                .build_with_interesting_tocker();
+        aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+        WHEN("checking 'A F x == 0'") {
+            aaltitoad::liveness_searcher searcher{};
+            auto results = searcher.search(n, {interpreter.compile("A F x == 0")});
+            THEN("the query holds") {
+                REQUIRE(results.begin()->holds());
+            }
+        }
+        WHEN("checking 'E G x > 0'") {
+            aaltitoad::liveness_searcher searcher{};
+            auto results = searcher.search(n, {interpreter.compile("E G x > 0")});
+            THEN("the query does not hold, since every path reaches x == 0") {
+                REQUIRE(!results.begin()->holds());
+            }
+        }
+        WHEN("checking 'E G x >= 0'") {
+            aaltitoad::liveness_searcher searcher{};
+            auto results = searcher.search(n, {interpreter.compile("E G x >= 0")});
+            THEN("the query holds with the deadlocking path as witness") {
+                REQUIRE(results.begin()->holds());
+                REQUIRE(std::get<bool>(results.begin()->solution.value()->second.data.symbols.at("x") == 0));
+            }
+        }
+    }
+    GIVEN("one tta looping forever between two locations") {
+        aaltitoad::ntta_builder builder{};
+        aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+        auto n = builder
+                .add_symbols({{"x", 0}})
+                .add_tta("A", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0", "L1", "L2"})
+                        .set_starting_location("L0")
+                        .add_edges({{"L0", "L1"}, {"L1", "L0"}, {"L1", "L2"}}))
+                .build_with_interesting_tocker();
+        aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+        WHEN("checking 'A F L2'") {
+            aaltitoad::liveness_searcher searcher{};
+            auto results = searcher.search(n, {interpreter.compile("A F L2")});
+            THEN("the query is violated by the L0-L1 lasso") {
+                REQUIRE(!results.begin()->holds());
+                auto& last = results.begin()->solution.value()->second;
+                REQUIRE(last.parent.has_value());
+                REQUIRE(last.data.components.at("A").current_location->first != "L2");
+            }
+        }
+        WHEN("checking 'A F L2' and 'E G x == 0' in one search") {
+            aaltitoad::liveness_searcher searcher{};
+            auto results = searcher.search(n, {interpreter.compile("A F L2"), interpreter.compile("E G x == 0")});
+            THEN("both queries are decided, although the second query revisits the states of the first") {
+                REQUIRE(results.size() == 2);
+                REQUIRE(!results[0].holds());
+                REQUIRE(results[1].holds());
+                REQUIRE(results[1].solution.value()->second.parent.has_value());
+            }
+        }
+    }
+}
+
+SCENARIO("best-first reachability", "[frs]") {
+    spdlog::set_level(spdlog::level::trace);
+    GIVEN("one tta with a branching chain of locations and a counter") {
+        aaltitoad::ntta_builder builder{};
+        aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+        auto n = builder
+                .add_symbols({{"x", 0}})
+                .add_tta("A", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0", "L1", "L2", "L3", "D0", "D1"})
+                        .set_starting_location("L0")
+                        .add_edges({{"L0", "L1"}, {"L1", "L2"}, {"L2", "L3"}, {"L0", "D0"}, {"D0", "D1"}, {"D1", "D0", "", "x := x + 1"}}))
+                .build_with_interesting_tocker();
+        aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+        WHEN("searching for a location with the best-first strategy") {
+            aaltitoad::forward_reachability_searcher frs{aaltitoad::pick_strategy::best_first};
+            auto results = frs.is_reachable(n, interpreter.compile("E F L3"));
+            THEN("the query is satisfied in L3") {
+                REQUIRE(results.begin()->solution.has_value());
+                REQUIRE(results.begin()->solution.value()->second.data.components.at("A").current_location->first == "L3");
+            }
+        }
+        WHEN("searching for a counter value with the best-first strategy") {
+            aaltitoad::forward_reachability_searcher frs{aaltitoad::pick_strategy::best_first};
+            auto results = frs.is_reachable(n, interpreter.compile("E F x == 3"));
+            THEN("the query is satisfied with x at 3") {
+                REQUIRE(results.begin()->solution.has_value());
+                REQUIRE(std::get<bool>(results.begin()->solution.value()->second.data.symbols.at("x") == 3));
+            }
+        }
+    }
+}
+
+SCENARIO("bounded model checking", "[bmc]") {
+    spdlog::set_level(spdlog::level::trace);
+    GIVEN("one tta with a simple count-down loop") {
+        aaltitoad::ntta_builder builder{};
+        aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+        auto n = builder
+                .add_symbols({{"x", 5}})
+                .add_tta("A", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0", "L1"})
+                        .set_starting_location("L0")
+                        .add_edges({{"L0", "L1", "x > 0", "x := x - 1"}, {"L1", "L0"}}))
+                .build();
+        aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+        WHEN("checking 'E F x == 0' with a bound that is large enough") {
+            aaltitoad::bounded_model_checker bmc{n, 10};
+            auto results = bmc.check({interpreter.compile("E F x == 0")});
+            THEN("the query is satisfied after nine ticks") {
+                REQUIRE(results[0].holds());
+                REQUIRE(results[0].trace.value().size() == 10);
+                REQUIRE(std::get<bool>(results[0].trace.value().back().symbols.at("x") == 0));
+            }
+        }
+        WHEN("checking 'E F x == 0' with a bound that is too small") {
+            aaltitoad::bounded_model_checker bmc{n, 4};
+            auto results = bmc.check({interpreter.compile("E F x == 0")});
+            THEN("no witness is found") {
+                REQUIRE_FALSE(results[0].holds());
+            }
+        }
+        WHEN("checking the safety queries 'A G x >= 0' and 'A G x > 0'") {
+            aaltitoad::bounded_model_checker bmc{n, 10};
+            auto results = bmc.check({interpreter.compile("A G x >= 0"), interpreter.compile("A G x > 0")});
+            THEN("only the first one holds within the bound") {
+                REQUIRE(results[0].holds());
+                REQUIRE_FALSE(results[1].holds());
+            }
+        }
+    }
+}
+
+SCENARIO("depth-bounded search", "[depth_bounded]") {
+    spdlog::set_level(spdlog::level::trace);
+    GIVEN("one tta with a simple count-down loop") {
+        aaltitoad::ntta_builder builder{};
+        aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+        auto n = builder
+                .add_symbols({{"x", 5}})
+                .add_tta("A", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0", "L1"})
+                        .set_starting_location("L0")
+                        .add_edges({{"L0", "L1", "x > 0", "x := x - 1"}, {"L1", "L0"}}))
+                .build();
+        aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+        auto trace_length = [](aaltitoad::depth_bounded_searcher::solution_t s) {
+            size_t length = 1;
+            for(; s->second.parent.has_value(); s = s->second.parent.value())
+                length++;
+            return length;
+        };
+        WHEN("searching for 'E F x == 0' with iterative deepening") {
+            aaltitoad::depth_bounded_searcher dbs{{.iterative_deepening = true}};
+            auto results = dbs.search(n, {interpreter.compile("E F x == 0")});
+            THEN("the witness is found after nine ticks") {
+                REQUIRE(results[0].solution.has_value());
+                REQUIRE(trace_length(results[0].solution.value()) == 10);
+            }
+        }
+        WHEN("searching for 'E F x == 0' with a max depth that is too small") {
+            aaltitoad::depth_bounded_searcher dbs{{.max_depth = 4}};
+            auto results = dbs.search(n, {interpreter.compile("E F x == 0")});
+            THEN("no witness is found") {
+                REQUIRE_FALSE(results[0].solution.has_value());
+            }
+        }
+        WHEN("checking 'A G x > 0' with a max depth that is smaller than the depth of the violation") {
+            aaltitoad::depth_bounded_searcher dbs{{.max_depth = 4}};
+            auto results = dbs.search(n, {interpreter.compile("A G x > 0")});
+            THEN("no counterexample is found, but the search is incomplete, so the query is undecided rather than holding") {
+                REQUIRE_FALSE(results[0].solution.has_value());
+                REQUIRE_FALSE(dbs.is_complete());
+            }
+        }
+        WHEN("checking 'A G x >= 0' without a depth bound") {
+            aaltitoad::depth_bounded_searcher dbs{{}};
+            auto results = dbs.search(n, {interpreter.compile("A G x >= 0")});
+            THEN("the full state-space is explored and the query holds") {
+                REQUIRE(results[0].holds());
+                REQUIRE(dbs.is_complete());
+            }
+        }
+    }
+    GIVEN("a state cache with room for two states") {
+        aaltitoad::bounded_state_cache cache{2};
+        auto state = [](uint8_t i) { return aaltitoad::encoded_state_t{{i}}; };
+        cache.visit(state(1), 5);
+        cache.visit(state(2), 5);
+        THEN("a state explored with a larger budget is pruned") {
+            REQUIRE(cache.visit(state(1), 3));
+        }
+        AND_THEN("a state with a larger budget than before is explored again") {
+            REQUIRE_FALSE(cache.visit(state(2), 7));
+        }
+        AND_THEN("the least recently used state is evicted") {
+            cache.visit(state(3), 5);
+            REQUIRE(cache.size() == 2);
+            REQUIRE_FALSE(cache.visit(state(1), 5));
+        }
+    }
+}
+
+SCENARIO("shortest trace search", "[frs]") {
+    spdlog::set_level(spdlog::level::trace);
+    GIVEN("one tta with a long and a short path to the same location") {
+        aaltitoad::ntta_builder builder{};
+        aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+        auto n = builder
+                .add_symbols({{"x", 0}})
+                .add_tta("A", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0", "L1", "L2", "L3", "T"})
+                        .set_starting_location("L0")
+                        .add_edges({{"L0", "L1", "x == 0", "x := 1"}, {"L1", "L2"}, {"L2", "L3"}, {"L3", "T"}, {"L0", "T", "x == 0", "x := 2"}}))
+                .build_with_interesting_tocker();
+        aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+        WHEN("searching for 'E F T' in shortest trace mode") {
+            aaltitoad::forward_reachability_searcher frs{};
+            frs.set_shortest_trace(true);
+            auto results = frs.is_reachable(n, interpreter.compile("E F T"));
+            THEN("the witness takes the direct edge") {
+                REQUIRE(results.begin()->solution.has_value());
+                REQUIRE(results.begin()->solution.value()->second.metadata.depth == 1);
+                REQUIRE(std::get<bool>(results.begin()->solution.value()->second.data.symbols.at("x") == 2));
+            }
+        }
+        WHEN("checking 'A G x != 1' in shortest trace mode") {
+            aaltitoad::forward_reachability_searcher frs{};
+            frs.set_shortest_trace(true);
+            auto results = frs.is_reachable(n, interpreter.compile("A G x != 1"));
+            THEN("the counterexample is one tick long") {
+                REQUIRE_FALSE(results.begin()->holds());
+                REQUIRE(results.begin()->solution.value()->second.metadata.depth == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("checkpointing and resuming searches", "[checkpoint]") {
+    spdlog::set_level(spdlog::level::trace);
+    GIVEN("one tta with a simple count-down loop") {
+        aaltitoad::ntta_builder builder{};
+        aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+        auto n = builder
+                .add_symbols({{"x", 5}, {"b", true}})
+                .add_tta("A", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0", "L1"})
+                        .set_starting_location("L0")
+                        .add_edges({{"L0", "L1", "x > 0", "x := x - 1"}, {"L1", "L0"}}))
+                .build();
+        aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+        WHEN("encoding and decoding a state") {
+            aaltitoad::state_codec codec{n};
+            auto s = n + n.tick()[0];
+            auto decoded = codec.decode(codec.encode(s));
+            THEN("the decoded state is equal to the original") {
+                REQUIRE(decoded == s);
+                REQUIRE(std::hash<aaltitoad::ntta_t>{}(decoded) == std::hash<aaltitoad::ntta_t>{}(s));
+            }
+        }
+        WHEN("interrupting a search and resuming it from the checkpoint") {
+            auto path = (std::filesystem::temp_directory_path() / "aaltitoad_checkpoint_test.bin").string();
+            auto query = interpreter.compile("E F x == 0");
+            aaltitoad::install_interrupt_handlers();
+            std::raise(SIGINT);
+            aaltitoad::forward_reachability_searcher interrupted{};
+            interrupted.set_checkpoint(path, std::chrono::minutes{0});
+            auto partial = interrupted.is_reachable(n, query);
+            aaltitoad::install_interrupt_handlers();
+            aaltitoad::forward_reachability_searcher resumed{};
+            resumed.set_resume(path);
+            auto results = resumed.is_reachable(n, query);
+            std::signal(SIGINT, SIG_DFL);
+            std::signal(SIGTERM, SIG_DFL);
+            std::filesystem::remove(path);
+            THEN("the interrupted search has no solution yet") {
+                REQUIRE_FALSE(partial.begin()->solution.has_value());
+            }
+            AND_THEN("the resumed search finds the solution") {
+                REQUIRE(results.begin()->solution.has_value());
+                REQUIRE(std::get<bool>(results.begin()->solution.value()->second.data.symbols.at("x") == 0));
+            }
+        }
+        WHEN("storing a hash compacted passed set in a checkpoint") {
+            auto path = (std::filesystem::temp_directory_path() / "aaltitoad_checkpoint_passed_set_test.bin").string();
+            aaltitoad::state_codec codec{n};
+            aaltitoad::compact_passed_set set{};
+            set.switch_to_hash_compaction();
+            set.insert(42);
+            set.insert(1337);
+            aaltitoad::checkpoint_writer writer{codec, {}};
+            writer.begin_section(0);
+            writer.begin_section(0);
+            writer.add_passed_set(set.snapshot());
+            writer.save(path);
+            aaltitoad::checkpoint_reader reader{codec, path};
+            reader.begin_section();
+            reader.begin_section();
+            aaltitoad::compact_passed_set restored{};
+            restored.restore(reader.next_passed_set());
+            std::filesystem::remove(path);
+            THEN("the restored set has the same storage mode and hashes") {
+                REQUIRE(restored.mode() == aaltitoad::storage_mode_t::hash_compaction);
+                REQUIRE(restored.contains(42));
+                REQUIRE(restored.contains(1337));
+                REQUIRE_FALSE(restored.contains(7));
+                REQUIRE(restored.size() == 2);
+            }
+        }
+    }
+}
+
+SCENARIO("external memory search", "[external_memory]") {
+    spdlog::set_level(spdlog::level::trace);
+    GIVEN("two ttas with count-down loops") {
+        aaltitoad::ntta_builder builder{};
+        aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+        auto n = builder
+                .add_symbols({{"x", 5}, {"y", 3}})
+                .add_tta("A", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0", "L1"})
+                        .set_starting_location("L0")
+                        .add_edges({{"L0", "L1", "x > 0", "x := x - 1"}, {"L1", "L0"}}))
+                .add_tta("B", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0", "L1"})
+                        .set_starting_location("L0")
+                        .add_edges({{"L0", "L1", "y > 0", "y := y - 1"}, {"L1", "L0", "", "y := 3"}}))
+                .build();
+        aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+        WHEN("searching with a budget that forces one run per successor") {
+            aaltitoad::external_memory_searcher ems{{std::filesystem::temp_directory_path(), 1}};
+            auto results = ems.search(n, {interpreter.compile("E F x == 0"), interpreter.compile("A G y >= 0")});
+            THEN("the reachability query is satisfied by a nine tick trace") {
+                REQUIRE(results[0].solution.has_value());
+                REQUIRE(results[0].solution.value()->second.metadata.depth == 9);
+                REQUIRE(std::get<bool>(results[0].solution.value()->second.data.symbols.at("x") == 0));
+            }
+            AND_THEN("the safety query holds") {
+                REQUIRE(results[1].holds());
+            }
+        }
+    }
+}
+
+SCENARIO("memory budgeted search", "[limits]") {
+    spdlog::set_level(spdlog::level::trace);
+    GIVEN("one tta counting to 50") {
+        aaltitoad::ntta_builder builder{};
+        aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+        auto n = builder
+                .add_symbols({{"x", 0}})
+                .add_tta("A", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0"})
+                        .set_starting_location("L0")
+                        .add_edge({"L0", "L0", "x < 50", "x := x + 1"}))
+                .build();
+        aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+        WHEN("searching with a state limit that is reached early") {
+            aaltitoad::forward_reachability_searcher frs{};
+            frs.set_limits({.state_limit = 10});
+            auto results = frs.is_reachable(n, {interpreter.compile("E F x == 50"), interpreter.compile("E F x == 100")});
+            THEN("the passed list is degraded to hash compaction") {
+                REQUIRE(frs.get_statistics().storage == aaltitoad::storage_mode_t::hash_compaction);
+                REQUIRE_FALSE(frs.get_statistics().stopped);
+            }
+            AND_THEN("the reachable state is still found") {
+                REQUIRE(results[0].solution.has_value());
+                REQUIRE(std::get<bool>(results[0].solution.value()->second.data.symbols.at("x") == 50));
+            }
+        }
+    }
+    GIVEN("a passed set in bitstate mode") {
+        aaltitoad::compact_passed_set set{};
+        set.switch_to_hash_compaction();
+        set.insert(42);
+        set.switch_to_bitstate(1024);
+        set.insert(1337);
+        THEN("states inserted before and after the switch are contained") {
+            REQUIRE(set.contains(42));
+            REQUIRE(set.contains(1337));
+            REQUIRE(set.size() == 2);
+        }
+    }
+}
+
+namespace {
+    struct counting_tocker_t : public aaltitoad::tocker_t {
+        size_t& calls;
+        explicit counting_tocker_t(size_t& calls) : calls{calls} {}
+        auto tock(const aaltitoad::ntta_t&) -> std::vector<expr::symbol_table_t> override { calls++; return {}; }
+        auto get_name() -> std::string override { return "counting_tocker"; }
+    };
+}
+
+SCENARIO("lazy tock expansion", "[frs]") {
+    spdlog::set_level(spdlog::level::trace);
+    GIVEN("one tta counting to 3 with a tocker that counts its calls") {
+        size_t calls = 0;
+        aaltitoad::ntta_builder builder{};
+        aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+        auto n = builder
+                .add_symbols({{"x", 0}})
+                .add_tta("A", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0"})
+                        .set_starting_location("L0")
+                        .add_edge({"L0", "L0", "x < 3", "x := x + 1"}))
+                .build();
+        n.add_tocker(std::make_shared<counting_tocker_t>(calls));
+        aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+        WHEN("searching for the first tick successor") {
+            aaltitoad::forward_reachability_searcher frs{};
+            auto results = frs.is_reachable(n, interpreter.compile("E F x == 1"));
+            THEN("the solution is found before the successor is tocked") {
+                REQUIRE(results[0].solution.has_value());
+                REQUIRE(calls == 1); // only the initial state
+            }
+        }
+        WHEN("searching the full state-space") {
+            aaltitoad::forward_reachability_searcher frs{};
+            auto results = frs.is_reachable(n, interpreter.compile("E F x == 4"));
+            THEN("every state is tocked exactly once") {
+                REQUIRE_FALSE(results[0].solution.has_value());
+                REQUIRE(calls == 4);
+            }
+        }
+    }
+}
+
+namespace {
+    // x := 1 from x == 0, then y := true from x == 1
+    struct stepping_tocker_t : public aaltitoad::tocker_t {
+        auto tock(const aaltitoad::ntta_t& state) -> std::vector<expr::symbol_table_t> override {
+            expr::symbol_table_t change{};
+            if(std::get<bool>(state.symbols.at("x") == 0))
+                change["x"] = 1;
+            else if(!std::get<bool>(state.symbols.at("y")))
+                change["y"] = true;
+            else
+                return {};
+            return {change};
+        }
+        auto get_name() -> std::string override { return "stepping_tocker"; }
+    };
+}
+
+SCENARIO("states that are both tick and tock successors", "[frs]") {
+    spdlog::set_level(spdlog::level::trace);
+    GIVEN("a tock successor of s0 that is also a tick successor of s0 and has tock successors of its own") {
+        aaltitoad::ntta_builder builder{};
+        aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+        auto n = builder
+                .add_symbols({{"x", 0}, {"y", false}, {"z", 0}})
+                .add_tta("A", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0"})
+                        .set_starting_location("L0")
+                        .add_edges({{"L0", "L0", "x == 0", "x := 1"}, {"L0", "L0", "x == 1 && !y", "z := 1"}}))
+                .build();
+        n.add_tocker(std::make_shared<stepping_tocker_t>());
+        aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+        // the pick order of W decides whether s0 is ticked before its tock successor is popped
+        WHEN("searching for a state that is only reachable by ticking the tock successor, picking the first state") {
+            aaltitoad::forward_reachability_searcher frs{aaltitoad::pick_strategy::first};
+            auto results = frs.is_reachable(n, interpreter.compile("E F z == 1"));
+            THEN("the tock successor is both tocked and ticked") {
+                REQUIRE(results[0].solution.has_value());
+            }
+        }
+        WHEN("searching for a state that is only reachable by ticking the tock successor, picking the last state") {
+            aaltitoad::forward_reachability_searcher frs{aaltitoad::pick_strategy::last};
+            auto results = frs.is_reachable(n, interpreter.compile("E F z == 1"));
+            THEN("the tock successor is both tocked and ticked") {
+                REQUIRE(results[0].solution.has_value());
+            }
+        }
+    }
+}
@@ -0,0 +1,577 @@
+/**
+ * aaltitoad - a verification engine for tick tock automata models
+   Copyright (C) 2023 Asger Gitz-Johansen
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "expr-wrappers/ctl-interpreter.h"
+#include <catch2/catch_test_macros.hpp>
+#include <ntta/builder/ntta_builder.h>
+#include <parser/hawk/hawk_parser.h>
+#include <verification/forward_reachability.h>
+#include <verification/tree_compression.h>
+#include <verification/packed_state_store.h>
+#include <verification/state_codec.h>
+#include <util/arena.h>
+#include <util/hash_kernel.h>
+#include <util/fingerprint_set.h>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <thread>
+#include <unordered_set>
+
+#ifndef AALTITOAD_PROJECT_DIR
+#define AALTITOAD_PROJECT_DIR "."
+#endif
+
+namespace {
+    // lower bound of the heap usage of a state stored in P. Red-black tree nodes carry a color and three pointers,
+    // and strings that do not fit the small string buffer are not counted
+    auto estimate_stored_bytes(const aaltitoad::ntta_t& state) -> size_t {
+        constexpr size_t tree_node_overhead = 4 * sizeof(void*);
+        using entry_t = std::pair<const size_t, aaltitoad::with_parent_t<aaltitoad::ntta_t, aaltitoad::search_metadata_t>>;
+        auto symbols = state.symbols.size() + state.external_symbols.size();
+        return tree_node_overhead + sizeof(entry_t)
+             + symbols * (tree_node_overhead + sizeof(expr::symbol_table_t::value_type))
+             + state.components.size() * (tree_node_overhead + sizeof(aaltitoad::ntta_t::tta_map_t::value_type));
+    }
+
+    // breadth-first enumeration of tick and tock successors, the same way the forward reachability searcher does
+    auto collect_states(const aaltitoad::ntta_t& s0, size_t max_states) -> std::vector<aaltitoad::ntta_t> {
+        aaltitoad::traceable_multimap<aaltitoad::ntta_t> seen{};
+        std::vector<aaltitoad::ntta_t> result{};
+        std::deque<aaltitoad::ntta_t> frontier{s0};
+        seen.add(s0);
+        auto visit = [&](const aaltitoad::ntta_t& s) {
+            if(seen.contains(s) || result.size() + frontier.size() >= max_states)
+                return;
+            seen.add(s);
+            frontier.push_back(s);
+        };
+        while(!frontier.empty()) {
+            auto s = frontier.front();
+            frontier.pop_front();
+            for(auto& si : s.tick()) {
+                auto sn = s + si;
+                visit(sn);
+                for(auto& so : sn.tock())
+                    visit(sn + so);
+            }
+            result.push_back(std::move(s));
+        }
+        return result;
+    }
+}
+
+SCENARIO("tree compressed state storage", "[tree_compression]") {
+    spdlog::set_level(spdlog::level::trace);
+    aaltitoad::ntta_builder builder{};
+    aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+    auto n = builder
+            .add_symbols({{"x", 0}, {"y", false}, {"z", 0.5f}, {"s", std::string{"hello"}}})
+            .add_tta("A", aaltitoad::tta_builder{&compiler}
+                    .add_locations({"L0", "L1"})
+                    .set_starting_location("L0")
+                    .add_edges({{"L0", "L1", "x < 10", "x := x + 1"}, {"L1", "L0", "", "y := !y"}}))
+            .build();
+    GIVEN("a store with the initial state") {
+        aaltitoad::tree_compressed_store store{n};
+        auto [root, inserted] = store.insert(n);
+        THEN("the state is new and can be found") {
+            REQUIRE(inserted);
+            REQUIRE(store.find(n) == root);
+            REQUIRE(store.size() == 1);
+        }
+        AND_THEN("decoding the root gives back the state") {
+            REQUIRE(store.decode(root) == n);
+        }
+        WHEN("inserting the state again") {
+            auto again = store.insert(n);
+            THEN("the same root is returned") {
+                REQUIRE_FALSE(again.second);
+                REQUIRE(again.first == root);
+                REQUIRE(store.size() == 1);
+            }
+        }
+        WHEN("inserting a successor") {
+            auto sn = n + n.tick()[0];
+            auto before = store.memory_bytes();
+            auto [sn_root, sn_inserted] = store.insert(sn);
+            THEN("the successor is a new state that decodes correctly") {
+                REQUIRE(sn_inserted);
+                REQUIRE(sn_root != root);
+                REQUIRE(store.decode(sn_root) == sn);
+                REQUIRE(store.decode(root) == n);
+                REQUIRE(store.memory_bytes() >= before);
+            }
+            AND_THEN("states that were never inserted are not found") {
+                auto unknown = sn + sn.tick()[0];
+                REQUIRE_FALSE(store.find(unknown).has_value());
+            }
+        }
+        WHEN("looking up a state with a string that was never inserted") {
+            auto unknown = n;
+            unknown.symbols["s"] = std::string{"world"};
+            auto found = store.find(unknown);
+            auto [unknown_root, unknown_inserted] = store.insert(unknown);
+            THEN("it is not found, and can still be inserted afterwards") {
+                REQUIRE_FALSE(found.has_value());
+                REQUIRE(unknown_inserted);
+                REQUIRE(store.decode(unknown_root) == unknown);
+                REQUIRE(store.find(unknown) == unknown_root);
+            }
+        }
+    }
+    GIVEN("a string pool") {
+        aaltitoad::string_pool_t pool{};
+        auto hello = pool.intern("hello");
+        WHEN("tagging strings without interning them") {
+            auto known = aaltitoad::to_tagged(expr::symbol_value_t{std::string{"hello"}}, nullptr, pool);
+            auto unknown = aaltitoad::to_tagged(expr::symbol_value_t{std::string{"world"}}, nullptr, pool);
+            THEN("only interned strings are tagged, and the pool does not grow") {
+                REQUIRE(known.has_value());
+                REQUIRE(known->payload == hello);
+                REQUIRE_FALSE(unknown.has_value());
+                REQUIRE_FALSE(pool.find("world").has_value());
+            }
+        }
+    }
+    GIVEN("a forward reachability search with tree compression") {
+        aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+        aaltitoad::forward_reachability_searcher frs{};
+        frs.set_tree_compression(true);
+        auto results = frs.is_reachable(n, interpreter.compile("E F x == 5"));
+        THEN("the state is found") {
+            REQUIRE(results[0].solution.has_value());
+            REQUIRE(std::get<bool>(results[0].solution.value()->second.data.symbols.at("x") == 5));
+        }
+        AND_THEN("the full trace is decoded back to the initial state") {
+            auto it = results[0].solution.value();
+            size_t length = 1;
+            while(it->second.parent.has_value()) {
+                it = it->second.parent.value();
+                length++;
+            }
+            REQUIRE(it->second.data == n);
+            REQUIRE(length >= 10);
+        }
+    }
+}
+
+SCENARIO("bit-packed state storage", "[packed_states]") {
+    spdlog::set_level(spdlog::level::trace);
+    aaltitoad::ntta_builder builder{};
+    aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+    auto n = builder
+            .add_symbols({{"x", 0}, {"y", false}, {"z", 0.5f}, {"s", std::string{"hello"}}, {"u", 0}})
+            .add_tta("A", aaltitoad::tta_builder{&compiler}
+                    .add_locations({"L0", "L1"})
+                    .set_starting_location("L0")
+                    .add_edges({{"L0", "L1", "x < 10", "x := x + 1"}, {"L1", "L0", "", "y := !y"}, {"L1", "L1", "u > 0", "u := u * 2"}}))
+            .build();
+    GIVEN("the inferred domains of the network") {
+        auto domains = aaltitoad::infer_domains(n);
+        THEN("the guarded counter is bounded by its guard") {
+            REQUIRE(domains.contains("x"));
+            REQUIRE(domains.at("x").min == 0);
+            REQUIRE(domains.at("x").max == 10);
+            REQUIRE(domains.at("x").width() == 4);
+        }
+        AND_THEN("the symbol that is only written behind an unsatisfiable guard keeps its initial value") {
+            REQUIRE(domains.contains("u"));
+            REQUIRE(domains.at("u").width() == 0);
+        }
+        AND_THEN("non-integer symbols are not bounded") {
+            REQUIRE_FALSE(domains.contains("y"));
+            REQUIRE_FALSE(domains.contains("z"));
+        }
+    }
+    GIVEN("a store with the initial state") {
+        aaltitoad::packed_state_store store{n};
+        auto [index, inserted] = store.insert(n);
+        THEN("every field is as narrow as its domain") {
+            REQUIRE(inserted);
+            REQUIRE(store.bits_per_state() == 1 + 4 + 1 + 32 + 32); // location, x, y, z, s and a constant u
+            REQUIRE(store.words_per_state() == 2);
+            REQUIRE(store.find(n) == index);
+            REQUIRE(store.decode(index) == n);
+        }
+        WHEN("inserting the state again") {
+            auto again = store.insert(n);
+            THEN("the same index is returned") {
+                REQUIRE_FALSE(again.second);
+                REQUIRE(again.first == index);
+                REQUIRE(store.size() == 1);
+            }
+        }
+        WHEN("inserting a successor") {
+            auto sn = n + n.tick()[0];
+            auto [sn_index, sn_inserted] = store.insert(sn);
+            THEN("the successor is a new state that decodes correctly") {
+                REQUIRE(sn_inserted);
+                REQUIRE(sn_index != index);
+                REQUIRE(store.decode(sn_index) == sn);
+                REQUIRE_FALSE(store.find(sn + sn.tick()[0]).has_value());
+            }
+        }
+        WHEN("inserting a state with a value outside of the inferred domain") {
+            auto bits = store.bits_per_state();
+            auto outside = n;
+            outside.symbols["x"] = 1000;
+            REQUIRE_FALSE(store.find(outside).has_value());
+            auto [outside_index, outside_inserted] = store.insert(outside);
+            THEN("the field is widened and all states are repacked") {
+                REQUIRE(outside_inserted);
+                REQUIRE(store.bits_per_state() > bits);
+                REQUIRE(store.decode(outside_index) == outside);
+                REQUIRE(store.decode(index) == n);
+                REQUIRE(store.find(n) == index);
+            }
+        }
+        WHEN("looking up a state with a string that was never inserted") {
+            auto unknown = n;
+            unknown.symbols["s"] = std::string{"world"};
+            THEN("it is not found") {
+                REQUIRE_FALSE(store.find(unknown).has_value());
+                REQUIRE(store.size() == 1);
+            }
+        }
+        WHEN("inserting a state where symbols changed their types") {
+            auto retyped = n;
+            retyped.symbols["x"] = 2.5f;
+            retyped.symbols["z"] = 3;
+            REQUIRE_FALSE(store.find(retyped).has_value());
+            auto [retyped_index, retyped_inserted] = store.insert(retyped);
+            THEN("the fields are retagged and all states are repacked") {
+                REQUIRE(retyped_inserted);
+                REQUIRE(store.decode(retyped_index) == retyped);
+                REQUIRE(std::holds_alternative<float>(static_cast<const expr::underlying_symbol_value_t&>(store.decode(retyped_index).symbols.at("x"))));
+                REQUIRE(store.decode(index) == n);
+                REQUIRE(store.find(n) == index);
+                REQUIRE(store.find(retyped) == retyped_index);
+            }
+        }
+    }
+    GIVEN("a forward reachability search with packed states") {
+        aaltitoad::ctl_interpreter interpreter{n.symbols, n.external_symbols};
+        aaltitoad::forward_reachability_searcher frs{};
+        frs.set_packed_states(true);
+        auto results = frs.is_reachable(n, interpreter.compile("E F x == 5"));
+        THEN("the state is found with the full trace") {
+            REQUIRE(results[0].solution.has_value());
+            auto it = results[0].solution.value();
+            REQUIRE(std::get<bool>(it->second.data.symbols.at("x") == 5));
+            while(it->second.parent.has_value())
+                it = it->second.parent.value();
+            REQUIRE(it->second.data == n);
+        }
+    }
+}
+
+SCENARIO("delta encoded states", "[state_codec]") {
+    spdlog::set_level(spdlog::level::trace);
+    aaltitoad::ntta_builder builder{};
+    aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+    auto n = builder
+            .add_symbols({{"a", 0}, {"b", 0}, {"c", false}})
+            .add_external_symbols({{"e", 0}})
+            .add_tta("A", aaltitoad::tta_builder{&compiler}
+                    .add_locations({"L0", "L1"})
+                    .set_starting_location("L0")
+                    .add_edge({"L0", "L1", "", "b := 3"}))
+            .add_tta("B", aaltitoad::tta_builder{&compiler}
+                    .add_locations({"L0"})
+                    .set_starting_location("L0"))
+            .build();
+    aaltitoad::state_codec codec{n};
+    GIVEN("the reference state") {
+        auto encoded = codec.encode_delta(n);
+        THEN("only the two list terminators are written") {
+            REQUIRE(encoded.bytes.size() == 2);
+            REQUIRE(codec.decode_delta(encoded) == n);
+        }
+    }
+    GIVEN("a state that differs from the reference in a location, an internal and an external symbol") {
+        auto sn = n + n.tick()[0];
+        sn.external_symbols["e"] = 4;
+        auto encoded = codec.encode_delta(sn);
+        THEN("the decoded state is the same state") {
+            auto decoded = codec.decode_delta(encoded);
+            REQUIRE(decoded == sn);
+            REQUIRE(std::get<bool>(decoded.symbols.at("b") == 3));
+            REQUIRE(std::get<bool>(decoded.external_symbols.at("e") == 4));
+        }
+        AND_THEN("the encoding is smaller than the full encoding and canonical") {
+            REQUIRE(encoded.bytes.size() < codec.encode(sn).size());
+            REQUIRE(codec.encode_delta(codec.decode_delta(encoded)) == encoded);
+            REQUIRE_FALSE(encoded == codec.encode_delta(n));
+        }
+    }
+}
+
+SCENARIO("arena allocation", "[arena]") {
+    spdlog::set_level(spdlog::level::trace);
+    GIVEN("an arena with small chunks") {
+        aaltitoad::memory::arena_resource arena{256};
+        WHEN("allocating more than a chunk") {
+            std::pmr::vector<uint64_t> values{&arena};
+            for(uint64_t i = 0; i < 100; i++)
+                values.push_back(i);
+            THEN("several chunks are used and allocations are counted") {
+                REQUIRE(values[99] == 99);
+                REQUIRE(arena.get_statistics().chunks > 1);
+                REQUIRE(arena.get_statistics().allocations > 1);
+            }
+        }
+        WHEN("resetting the arena") {
+            { std::pmr::vector<uint64_t> values(100, 0, &arena); }
+            arena.reset();
+            THEN("only the first chunk is kept") {
+                REQUIRE(arena.get_statistics().chunks == 1);
+                REQUIRE(arena.get_statistics().bytes == 0);
+            }
+        }
+    }
+    GIVEN("a scratch scope") {
+        aaltitoad::memory::arena_resource arena{};
+        auto* before = aaltitoad::memory::scratch_resource();
+        {
+            aaltitoad::memory::scratch_scope scope{arena};
+            THEN("the arena is the scratch resource while the scope is active") {
+                REQUIRE(aaltitoad::memory::scratch_resource() == &arena);
+            }
+        }
+        THEN("the previous resource is restored afterwards") {
+            REQUIRE(aaltitoad::memory::scratch_resource() == before);
+        }
+    }
+    GIVEN("a forward reachability search") {
+        aaltitoad::ntta_builder builder{};
+        aaltitoad::expression_driver compiler{builder.symbols, builder.external_symbols};
+        auto n = builder
+                .add_symbols({{"x", 0}})
+                .add_tta("A", aaltitoad::tta_builder{&compiler}
+                        .add_locations({"L0"})
+                        .set_starting_location("L0")
+                        .add_edge({"L0", "L0", "x < 10", "x := x + 1"}))
+                .build();
+        aaltitoad::forward_reachability_searcher frs{};
+        frs.is_reachable(n, aaltitoad::ctl_interpreter{n.symbols, n.external_symbols}.compile("E F x == 20"));
+        THEN("stored states and tick scratch are allocated from the arenas") {
+            REQUIRE(frs.get_statistics().stored_allocations >= 11);
+            REQUIRE(frs.get_statistics().scratch_allocations > 0);
+        }
+    }
+}
+
+SCENARIO("hashing and comparing contiguous states", "[hash_kernel]") {
+    spdlog::set_level(spdlog::level::trace);
+    using namespace aaltitoad::hashing;
+    auto initial = active_kernel();
+    std::vector<uint64_t> words(33);
+    for(size_t i = 0; i < words.size(); i++)
+        words[i] = i * 0x9e3779b97f4a7c15ull;
+    GIVEN("buffers of every length up to a few stripes") {
+        THEN("all supported kernels compute the same hashes and comparisons") {
+            for(auto kernel : {kernel_t::scalar, kernel_t::avx2}) {
+                if(!is_supported(kernel))
+                    continue;
+                std::vector<uint64_t> hashes{};
+                for(size_t size = 0; size <= words.size() * sizeof(uint64_t); size++) {
+                    REQUIRE(use_kernel(kernel_t::scalar));
+                    auto expected = hash_bytes(words.data(), size);
+                    REQUIRE(use_kernel(kernel));
+                    REQUIRE(hash_bytes(words.data(), size) == expected);
+                    auto other = words;
+                    if(size > 0)
+                        reinterpret_cast<unsigned char*>(other.data())[size - 1] ^= 1;
+                    REQUIRE(equal_bytes(words.data(), other.data(), size) == (size == 0));
+                }
+            }
+        }
+    }
+    GIVEN("word vectors that only differ in the order of two words") {
+        std::vector<uint64_t> swapped = words;
+        std::swap(swapped[1], swapped[6]);
+        THEN("the hashes differ") {
+            REQUIRE(hash_words(words.data(), words.size()) != hash_words(swapped.data(), swapped.size()));
+            REQUIRE_FALSE(equal_words(words.data(), swapped.data(), words.size()));
+        }
+    }
+    use_kernel(initial);
+}
+
+SCENARIO("concurrent fingerprint set", "[fingerprint_set]") {
+    spdlog::set_level(spdlog::level::trace);
+    GIVEN("a small set") {
+        aaltitoad::concurrent_fingerprint_set set{16};
+        WHEN("inserting more fingerprints than it has slots") {
+            for(uint64_t i = 2; i < 1000; i++)
+                REQUIRE(set.insert(i * 31));
+            THEN("the set grows and keeps every fingerprint") {
+                REQUIRE(set.size() == 998);
+                REQUIRE(set.capacity() > 998);
+                for(uint64_t i = 2; i < 1000; i++)
+                    REQUIRE(set.contains(i * 31));
+                REQUIRE_FALSE(set.contains(1001 * 31));
+            }
+            AND_THEN("inserting a fingerprint again is rejected") {
+                REQUIRE_FALSE(set.insert(31 * 2));
+                REQUIRE(set.size() == 998);
+            }
+            AND_THEN("every fingerprint is visited once") {
+                size_t visited = 0;
+                set.for_each([&visited](uint64_t){ visited++; });
+                REQUIRE(visited == 998);
+                set.reclaim();
+                REQUIRE(set.contains(31 * 999));
+            }
+        }
+    }
+    GIVEN("threads that insert overlapping ranges of fingerprints") {
+        aaltitoad::concurrent_fingerprint_set set{64};
+        constexpr uint64_t per_thread = 20000, threads = 8;
+        std::atomic<size_t> accepted{};
+        std::vector<std::thread> workers{};
+        for(uint64_t t = 0; t < threads; t++)
+            workers.emplace_back([&set, &accepted, t]() {
+                for(uint64_t i = 0; i < per_thread; i++)
+                    if(set.insert(2 + t * per_thread / 2 + i))
+                        accepted++;
+            });
+        for(auto& worker : workers)
+            worker.join();
+        THEN("every fingerprint is accepted exactly once") {
+            auto distinct = (threads + 1) * per_thread / 2;
+            REQUIRE(accepted == distinct);
+            REQUIRE(set.size() == distinct);
+            for(uint64_t i = 2; i < 2 + distinct; i++)
+                REQUIRE(set.contains(i));
+        }
+    }
+}
+
+SCENARIO("tree compression memory usage on fischer-5", "[.benchmark][tree_compression]") {
+    spdlog::set_level(spdlog::level::info);
+    std::vector<std::string> folders{AALTITOAD_PROJECT_DIR "/test/verification/fischer-suite/fischer-5"}, ignore_list{".*\\.ignore\\.txt"};
+    std::unique_ptr<aaltitoad::ntta_t> n{aaltitoad::hawk::load(folders, ignore_list)};
+    auto states = collect_states(*n, 50000);
+    aaltitoad::tree_compressed_store store{*n};
+    size_t baseline = 0;
+    for(auto& s : states) {
+        store.insert(s);
+        baseline += estimate_stored_bytes(s);
+    }
+    spdlog::info("fischer-5: {0} states, with_parent_t<ntta_t> >= {1} bytes ({2} per state), tree compression {3} bytes ({4} per state), {5:.1f}x reduction",
+                 states.size(), baseline, baseline / states.size(), store.memory_bytes(), store.memory_bytes() / states.size(),
+                 static_cast<double>(baseline) / static_cast<double>(store.memory_bytes()));
+    REQUIRE(store.size() == states.size());
+    REQUIRE(store.memory_bytes() < baseline);
+    for(size_t i = 0; i < states.size(); i += states.size() / 100 + 1)
+        REQUIRE(store.decode(store.find(states[i]).value()) == states[i]);
+}
+
+SCENARIO("packed state memory usage on fischer-5", "[.benchmark][packed_states]") {
+    spdlog::set_level(spdlog::level::info);
+    std::vector<std::string> folders{AALTITOAD_PROJECT_DIR "/test/verification/fischer-suite/fischer-5"}, ignore_list{".*\\.ignore\\.txt"};
+    std::unique_ptr<aaltitoad::ntta_t> n{aaltitoad::hawk::load(folders, ignore_list)};
+    auto states = collect_states(*n, 50000);
+    aaltitoad::packed_state_store store{*n};
+    size_t baseline = 0;
+    for(auto& s : states) {
+        store.insert(s);
+        baseline += estimate_stored_bytes(s);
+    }
+    spdlog::info("fischer-5: {0} states, with_parent_t<ntta_t> >= {1} bytes ({2} per state), packed {3} bits per state in {4} bytes, {5:.1f}x reduction",
+                 states.size(), baseline, baseline / states.size(), store.bits_per_state(), store.memory_bytes(),
+                 static_cast<double>(baseline) / static_cast<double>(store.memory_bytes()));
+    REQUIRE(store.size() == states.size());
+    REQUIRE(store.memory_bytes() < baseline);
+    for(size_t i = 0; i < states.size(); i += states.size() / 100 + 1)
+        REQUIRE(store.decode(store.find(states[i]).value()) == states[i]);
+}
+
+SCENARIO("hash kernel throughput and collision rates on the fischer suite", "[.benchmark][hash_kernel]") {
+    spdlog::set_level(spdlog::level::info);
+    using namespace aaltitoad::hashing;
+    auto initial = active_kernel();
+    for(size_t words : {2, 4, 16, 64}) {
+        std::vector<uint64_t> buffer(words * 4096);
+        for(size_t i = 0; i < buffer.size(); i++)
+            buffer[i] = i * 0x9e3779b97f4a7c15ull;
+        for(auto kernel : {kernel_t::scalar, kernel_t::avx2}) {
+            if(!use_kernel(kernel))
+                continue;
+            uint64_t sink = 0;
+            auto start = std::chrono::steady_clock::now();
+            for(int round = 0; round < 100; round++)
+                for(size_t i = 0; i + words <= buffer.size(); i += words)
+                    sink ^= hash_words(buffer.data() + i, words) + equal_words(buffer.data(), buffer.data() + i, words);
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            auto calls = 100.0 * static_cast<double>(buffer.size() / words);
+            spdlog::info("{0} kernel, {1} words: {2:.1f} ns per hash and comparison ({3:x})", to_string(kernel), words, elapsed.count() / calls, sink);
+        }
+    }
+    use_kernel(initial);
+    // expected number of occupied-slot collisions when throwing n keys into m slots
+    auto expected_collisions = [](double n, double m) { return n - m * (1.0 - std::pow(1.0 - 1.0 / m, n)); };
+    for(auto size : {2, 3, 4, 5, 6}) {
+        std::vector<std::string> folders{AALTITOAD_PROJECT_DIR "/test/verification/fischer-suite/fischer-" + std::to_string(size)}, ignore_list{".*\\.ignore\\.txt"};
+        std::unique_ptr<aaltitoad::ntta_t> n{aaltitoad::hawk::load(folders, ignore_list)};
+        auto states = collect_states(*n, 50000);
+        aaltitoad::state_codec codec{*n};
+        auto slots = std::bit_ceil(states.size());
+        std::unordered_set<uint64_t> kernel_hashes{}, kernel_slots{}, std_hashes{}, std_slots{};
+        for(auto& s : states) {
+            auto encoded = codec.encode(s);
+            auto h = hash_bytes(encoded.data(), encoded.size());
+            kernel_hashes.insert(h);
+            kernel_slots.insert(h & (slots - 1));
+            auto hs = std::hash<aaltitoad::ntta_t>{}(s);
+            std_hashes.insert(hs);
+            std_slots.insert(hs & (slots - 1));
+        }
+        spdlog::info("fischer-{0}: {1} states, 64 bit collisions: kernel {2}, std::hash {3}. Slot collisions in {4} slots: kernel {5}, std::hash {6}, expected {7:.0f}",
+                     size, states.size(), states.size() - kernel_hashes.size(), states.size() - std_hashes.size(),
+                     slots, states.size() - kernel_slots.size(), states.size() - std_slots.size(),
+                     expected_collisions(static_cast<double>(states.size()), static_cast<double>(slots)));
+        REQUIRE(kernel_hashes.size() == states.size());
+    }
+}
+
+SCENARIO("concurrent fingerprint set contention", "[.benchmark][fingerprint_set]") {
+    spdlog::set_level(spdlog::level::info);
+    constexpr uint64_t inserts = 1 << 22;
+    for(uint64_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+        // half of the inserts are duplicates, and the set starts small such that it has to grow during the run
+        aaltitoad::concurrent_fingerprint_set set{1024};
+        std::vector<std::thread> workers{};
+        auto start = std::chrono::steady_clock::now();
+        for(uint64_t t = 0; t < threads; t++)
+            workers.emplace_back([&set, t, threads]() {
+                for(uint64_t i = t; i < inserts; i += threads) {
+                    auto key = i / 2;
+                    set.insert(aaltitoad::hashing::hash_words(&key, 1));
+                }
+            });
+        for(auto& worker : workers)
+            worker.join();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        spdlog::info("{0} threads: {1:.1f} million inserts per second, {2} fingerprints in {3} slots ({4} bytes)",
+                     threads, static_cast<double>(inserts) / elapsed.count() / 1e6, set.size(), set.capacity(), set.memory_bytes());
+        REQUIRE(set.size() <= inserts / 2);
+    }
+}